@@ -2,6 +2,8 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 QT += printsupport
+QT += concurrent
+QT += network
 CONFIG += c++11
 
 # The following define makes your compiler emit warnings if you use
@@ -10,21 +12,77 @@ CONFIG += c++11
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# per-phase timers of the training loop (profiler.h), remove to compile them out
+CONFIG += rrbf_profiling
+rrbf_profiling: DEFINES += RRBF_PROFILING
+
 # You can also make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    batcher.cpp \
+    commandline.cpp \
+    compress.cpp \
+    growing.cpp \
+    harness.cpp \
+    hogwild.cpp \
+    kmeans.cpp \
+    leastsquares.cpp \
+    levenbergmarquardt.cpp \
+    linalg.cpp \
+    loadgen.cpp \
     main.cpp \
     mainwindow.cpp \
+    metrics.cpp \
+    modelstore.cpp \
+    multimodel.cpp \
+    optimizer.cpp \
+    perfcounters.cpp \
+    predictor.cpp \
+    prioritized.cpp \
+    profiler.cpp \
+    pruning.cpp \
     qcustomplot.cpp \
+    rrbfnetwork.cpp \
+    rrbftrainer.cpp \
+    schedule.cpp \
+    search.cpp \
+    server.cpp \
+    sizing.cpp \
+    sparse.cpp \
+    sumtree.cpp \
     testing.cpp \
+    threadpool.cpp \
     training.cpp
 
 HEADERS += \
+    basis.h \
+    batcher.h \
+    commandline.h \
+    compress.h \
+    harness.h \
+    hogwild.h \
+    linalg.h \
+    loadgen.h \
     mainwindow.h \
-    qcustomplot.h
+    metrics.h \
+    modelstore.h \
+    multimodel.h \
+    optimizer.h \
+    perfcounters.h \
+    predictor.h \
+    profiler.h \
+    qcustomplot.h \
+    rrbfnetwork.h \
+    rrbftrainer.h \
+    schedule.h \
+    search.h \
+    server.h \
+    sizing.h \
+    sumtree.h \
+    threadpool.h
 
 FORMS += \
     mainwindow.ui
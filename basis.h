@@ -0,0 +1,165 @@
+#ifndef BASIS_H
+#define BASIS_H
+
+#include <cmath>
+
+// Basis functions of a neuron with center m and width s (the stdDev). All
+// kernels share the parameter layout of the RRBF network, the center is the
+// point (m, m) of the radial kernels. The kernels are policies with static
+// members, the loops in RRBFNetwork, RRBFPredictor and HogwildTrainer are
+// templates on them and instantiated once per kernel:
+//
+//   phi(dx, dy, k)         the value at dx = x - m, dy = y - m, k = 1 / (2 s^2)
+//   gradients(dx, dy, s, dStdDev, dCenter)
+//                          the value, d phi / d s and d phi / d m
+//   cutoff(threshold)      the bound sparseGradients() compares with, once per call
+//   sparseGradients(dx, dy, s, cutoff, phi, dStdDev, dCenter)
+//                          false when the neuron is negligible at this input,
+//                          tested before any exp; parts below the threshold count as zero
+enum BasisFunction { GaussianSumBasis, RadialGaussianBasis, WendlandBasis, InverseMultiquadricBasis };
+
+// exp(-dx^2 / 2s^2) + exp(-dy^2 / 2s^2), the original RRBF kernel: two exp
+struct GaussianSumKernel
+{
+    static double phi(double dx, double dy, double k)
+    {
+        return std::exp(-dx * dx * k) + std::exp(-dy * dy * k);
+    }
+
+    static double gradients(double dx, double dy, double s, double& dStdDev, double& dCenter)
+    {
+        const double k = 1.0 / (2 * s * s);
+        const double phi_x = std::exp(-dx * dx * k);
+        const double phi_y = std::exp(-dy * dy * k);
+        dStdDev = phi_x * (dx * dx / (s * s * s)) + phi_y * (dy * dy / (s * s * s));
+        dCenter = phi_x * (dx / (s * s)) + phi_y * (dy / (s * s));
+        return phi_x + phi_y;
+    }
+
+    // phi_x > threshold  <=>  dx^2 / (2 s^2) < -ln(threshold), the same for phi_y
+    static double cutoff(double threshold)
+    {
+        return -std::log(threshold);
+    }
+
+    static bool sparseGradients(double dx, double dy, double s, double cutoff, double& phi, double& dStdDev, double& dCenter)
+    {
+        const double k = 1.0 / (2 * s * s);
+        const double ax = dx * dx * k;
+        const double ay = dy * dy * k;
+        if (ax >= cutoff && ay >= cutoff) return false;
+
+        const double phi_x = (ax < cutoff) ? std::exp(-ax) : 0.0;
+        const double phi_y = (ay < cutoff) ? std::exp(-ay) : 0.0;
+        dStdDev = phi_x * (dx * dx / (s * s * s)) + phi_y * (dy * dy / (s * s * s));
+        dCenter = phi_x * (dx / (s * s)) + phi_y * (dy / (s * s));
+        phi = phi_x + phi_y;
+        return true;
+    }
+};
+
+// exp(-(dx^2 + dy^2) / 2s^2), the classic radial Gaussian: one exp
+struct RadialGaussianKernel
+{
+    static double phi(double dx, double dy, double k)
+    {
+        return std::exp(-(dx * dx + dy * dy) * k);
+    }
+
+    static double gradients(double dx, double dy, double s, double& dStdDev, double& dCenter)
+    {
+        const double d2 = dx * dx + dy * dy;
+        const double value = std::exp(-d2 / (2 * s * s));
+        dStdDev = value * d2 / (s * s * s);
+        dCenter = value * (dx + dy) / (s * s);
+        return value;
+    }
+
+    static double cutoff(double threshold)
+    {
+        return -std::log(threshold);
+    }
+
+    static bool sparseGradients(double dx, double dy, double s, double cutoff, double& phi, double& dStdDev, double& dCenter)
+    {
+        if ((dx * dx + dy * dy) / (2 * s * s) >= cutoff) return false;
+        phi = gradients(dx, dy, s, dStdDev, dCenter);
+        return true;
+    }
+};
+
+// Wendland C2 function (1 - r)^4 (4r + 1) for r = |(dx, dy)| / s < 1, zero
+// outside: one sqrt, and exactly zero beyond the support radius s
+struct WendlandKernel
+{
+    static double phi(double dx, double dy, double k)
+    {
+        const double r = std::sqrt(2 * k * (dx * dx + dy * dy));
+        if (r >= 1.0) return 0.0;
+        const double t = 1.0 - r;
+        return t * t * t * t * (4 * r + 1);
+    }
+
+    static double gradients(double dx, double dy, double s, double& dStdDev, double& dCenter)
+    {
+        const double r = std::sqrt(dx * dx + dy * dy) / s;
+        if (r >= 1.0) {
+            dStdDev = dCenter = 0.0;
+            return 0.0;
+        }
+        //d phi / dr = -20 r (1 - r)^3
+        const double t = 1.0 - r;
+        const double t3 = t * t * t;
+        dStdDev = 20 * r * r * t3 / s;
+        dCenter = 20 * t3 * (dx + dy) / (s * s);
+        return t3 * t * (4 * r + 1);
+    }
+
+    // the support, independent of the threshold
+    static double cutoff(double)
+    {
+        return 1.0;
+    }
+
+    static bool sparseGradients(double dx, double dy, double s, double cutoff, double& phi, double& dStdDev, double& dCenter)
+    {
+        if (dx * dx + dy * dy >= cutoff * s * s) return false;
+        phi = gradients(dx, dy, s, dStdDev, dCenter);
+        return true;
+    }
+};
+
+// 1 / sqrt(1 + (dx^2 + dy^2) / s^2), inverse multiquadric: one sqrt, heavy tails
+struct InverseMultiquadricKernel
+{
+    static double phi(double dx, double dy, double k)
+    {
+        return 1.0 / std::sqrt(1.0 + 2 * k * (dx * dx + dy * dy));
+    }
+
+    static double gradients(double dx, double dy, double s, double& dStdDev, double& dCenter)
+    {
+        //d phi / dq = -phi^3 / 2 for q = (dx^2 + dy^2) / s^2
+        const double q = (dx * dx + dy * dy) / (s * s);
+        const double value = 1.0 / std::sqrt(1.0 + q);
+        const double value3 = value * value * value;
+        dStdDev = value3 * q / s;
+        dCenter = value3 * (dx + dy) / (s * s);
+        return value;
+    }
+
+    // phi > threshold  <=>  q < 1 / threshold^2 - 1
+    static double cutoff(double threshold)
+    {
+        return 1.0 / (threshold * threshold) - 1.0;
+    }
+
+    static bool sparseGradients(double dx, double dy, double s, double cutoff, double& phi, double& dStdDev, double& dCenter)
+    {
+        if ((dx * dx + dy * dy) / (s * s) >= cutoff) return false;
+        phi = gradients(dx, dy, s, dStdDev, dCenter);
+        return true;
+    }
+};
+
+#endif // BASIS_H
@@ -0,0 +1,97 @@
+#include "batcher.h"
+
+#include <algorithm>
+
+MicroBatcher::MicroBatcher(const ModelStore& store_, int maxBatchSize_, std::chrono::microseconds maxWait_)
+    : store(store_)
+    , maxBatchSize(static_cast<std::size_t>(std::max(1, maxBatchSize_)))
+    , maxWait(maxWait_)
+{
+    stopping = false;
+    batches = 0;
+    requests = 0;
+    batch.reserve(maxBatchSize);
+    xs.resize(maxBatchSize);
+    ys.resize(maxBatchSize);
+    outputs.resize(maxBatchSize);
+    worker = std::thread(&MicroBatcher::run, this);
+}
+
+MicroBatcher::~MicroBatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work.notify_one();
+    worker.join();
+}
+
+double MicroBatcher::predict(double x, double y)
+{
+    Request request;
+    request.x = x;
+    request.y = y;
+    request.result = 0.0;
+    request.done = false;
+    request.arrival = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    queue.push_back(&request);
+    //the worker only needs a wake up for the first request and a full batch
+    if (queue.size() == 1 || queue.size() >= maxBatchSize) work.notify_one();
+    completed.wait(lock, [&request]() { return request.done; });
+    return request.result;
+}
+
+long long MicroBatcher::batchCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return batches;
+}
+
+long long MicroBatcher::requestCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return requests;
+}
+
+void MicroBatcher::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) return; //stopping, every caller has been answered
+
+        //give the batch until maxWait after its oldest request to fill up
+        //a timed wait on a passed deadline still costs a futex call, skip it
+        const auto deadline = queue.front()->arrival + maxWait;
+        if (queue.size() < maxBatchSize && std::chrono::steady_clock::now() < deadline) {
+            work.wait_until(lock, deadline, [this]() { return stopping || queue.size() >= maxBatchSize; });
+        }
+
+        const std::size_t size = std::min(queue.size(), maxBatchSize);
+        batch.assign(queue.begin(), queue.begin() + size);
+        queue.erase(queue.begin(), queue.begin() + size);
+        lock.unlock();
+
+        for (std::size_t s = 0; s < size; ++s) {
+            xs[s] = batch[s]->x;
+            ys[s] = batch[s]->y;
+        }
+        {
+            ModelStore::ReadGuard model(store);
+            if (model) model->predict(xs.data(), ys.data(), outputs.data(), size);
+            else std::fill(outputs.begin(), outputs.begin() + size, 0.0);
+        }
+
+        lock.lock();
+        for (std::size_t s = 0; s < size; ++s) {
+            batch[s]->result = outputs[s];
+            batch[s]->done = true;
+        }
+        batches++;
+        requests += size;
+        completed.notify_all();
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef BATCHER_H
+#define BATCHER_H
+
+#include "modelstore.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Front end for concurrent single-point predictions. Callers of predict()
+// block while a worker thread collects their requests into batches of at
+// most maxBatchSize, waits at most maxWait after the oldest request for
+// the batch to fill up, runs one batched forward pass on the current model
+// of the store and wakes the callers. No Qt types, like RRBFPredictor.
+class MicroBatcher
+{
+public:
+    MicroBatcher(const ModelStore& store_, int maxBatchSize_, std::chrono::microseconds maxWait_);
+    ~MicroBatcher();
+
+    double predict(double x, double y);
+
+    // since construction
+    long long batchCount() const;
+    long long requestCount() const;
+
+private:
+    MicroBatcher(const MicroBatcher&) = delete;
+    MicroBatcher& operator=(const MicroBatcher&) = delete;
+
+    struct Request
+    {
+        double x, y;
+        double result;
+        bool done;
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    void run();
+
+    const ModelStore& store;
+    const std::size_t maxBatchSize;
+    const std::chrono::microseconds maxWait;
+
+    mutable std::mutex mutex;
+    std::condition_variable work;       // worker: new requests or stop
+    std::condition_variable completed;  // callers: a batch is done
+    std::deque<Request*> queue;
+    bool stopping;
+    long long batches, requests;
+
+    std::vector<Request*> batch;        // worker buffers, allocated once
+    std::vector<double> xs, ys, outputs;
+    std::thread worker;
+};
+
+#endif // BATCHER_H
@@ -0,0 +1,51 @@
+# Microbenchmarks for the RRBF kernels (Google Benchmark)
+#
+#   qmake && make
+#   ./rrbf_benchmark --benchmark_format=json --benchmark_out=kernels.json
+#
+# Pass --seed=<n> to change the random network/data (default 1).
+
+QT       -= gui
+QT       += concurrent
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TARGET = rrbf_benchmark
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    rrbf_benchmark.cpp \
+    ../growing.cpp \
+    ../hogwild.cpp \
+    ../kmeans.cpp \
+    ../leastsquares.cpp \
+    ../levenbergmarquardt.cpp \
+    ../linalg.cpp \
+    ../multimodel.cpp \
+    ../optimizer.cpp \
+    ../perfcounters.cpp \
+    ../predictor.cpp \
+    ../prioritized.cpp \
+    ../profiler.cpp \
+    ../rrbfnetwork.cpp \
+    ../rrbftrainer.cpp \
+    ../schedule.cpp \
+    ../sparse.cpp \
+    ../sumtree.cpp
+
+HEADERS += \
+    ../basis.h \
+    ../hogwild.h \
+    ../linalg.h \
+    ../multimodel.h \
+    ../optimizer.h \
+    ../perfcounters.h \
+    ../predictor.h \
+    ../profiler.h \
+    ../rrbfnetwork.h \
+    ../rrbftrainer.h \
+    ../schedule.h \
+    ../sumtree.h
+
+LIBS += -lbenchmark -lpthread
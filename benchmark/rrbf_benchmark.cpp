@@ -0,0 +1,356 @@
+#include "hogwild.h"
+#include "multimodel.h"
+#include "rrbfnetwork.h"
+#include "rrbftrainer.h"
+#include "perfcounters.h"
+#include "predictor.h"
+
+#include <benchmark/benchmark.h>
+#include <QByteArray>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+// Kernel benchmarks, swept over neurons x batch size.
+//
+// Counters:
+//   ns_per_sample  wall time per (x, y) sample
+//   exps_per_s     qExp calls per second (2 per neuron and sample)
+//   GFLOP/s        floating point operations per second, exp not counted
+//   evaluated      share of the neuron terms a culled predictor computes
+//   gradient_ns_per_neuron, predict_ns_per_neuron
+//                  Basis: computeGradients() and RRBFPredictor per neuron and sample
+//   ns_per_model_sample
+//                  MultiModel: wall time of one SGD step of one model
+//   updates_per_s, error_per_s
+//                  Hogwild: SGD updates of all threads per wall second and
+//                  error decrease per wall second until the target error
+//   IPC, cycles_per_sample, cache_misses_per_sample, branch_misses_per_sample
+//                  hardware counters of the timed loop (Forward and Gradient,
+//                  Linux only, left out when perf_event_open is not permitted)
+//
+// Flop counts per neuron and sample for the default GaussianSumKernel, read
+// off basis.h and rrbfnetwork.cpp (shared subexpressions counted once):
+//   forward   12  (2 sub, 1 / (2 delta^2): 2 mul + div, 2 x [square, mul], add, mul, add)
+//   gradient  28  (one kernel pass: forward without the output + 3 for delta^3,
+//                  6 for the stdDev and 5 for the center derivative, 2 for the
+//                  output; 5 in the gradient loop)
+//   update     6  (SGD: 3 x mul + sub)
+
+namespace {
+
+const double forwardFlops = 12.0;
+const double gradientFlops = 28.0;
+const double updateFlops = 6.0;
+
+quint32 benchmarkSeed = 1;
+
+TrainingSet randomSamples(int count)
+{
+    const quint32 seedBuffer[2] = { benchmarkSeed, 0x5eed5eedu };
+    QRandomGenerator rng(seedBuffer);
+    TrainingSet samples;
+    samples.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        double x = rng.generateDouble() * 6.0 - 3.0;
+        double y = rng.generateDouble() * 6.0 - 3.0;
+        samples.push_back({{x, y}, RRBFNetwork::targetFunction(x, y)});
+    }
+    return samples;
+}
+
+void setCounters(benchmark::State& state, double samplesPerIteration, double flopsPerNeuronSample)
+{
+    const double neurons = static_cast<double>(state.range(0));
+    const double samples = samplesPerIteration * state.iterations();
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["ns_per_sample"] = benchmark::Counter(samples * 1e-9,
+                                                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["exps_per_s"] = benchmark::Counter(2.0 * neurons * samples, benchmark::Counter::kIsRate);
+    state.counters["GFLOP/s"] = benchmark::Counter(flopsPerNeuronSample * neurons * samples * 1e-9,
+                                                   benchmark::Counter::kIsRate);
+}
+
+void setPerfCounters(benchmark::State& state, const PerfCounters& perf, double samplesPerIteration)
+{
+    if (!perf.isOpen()) return;
+    const PerfCounterValues values = perf.read();
+    const double samples = samplesPerIteration * state.iterations();
+    state.counters["IPC"] = values.ipc();
+    state.counters["cycles_per_sample"] = values.cycles / samples;
+    state.counters["cache_misses_per_sample"] = values.cacheMisses / samples;
+    state.counters["branch_misses_per_sample"] = values.branchMisses / samples;
+}
+
+void BM_Forward(benchmark::State& state)
+{
+    const int numNeurons = static_cast<int>(state.range(0));
+    const int batchSize = static_cast<int>(state.range(1));
+    RRBFNetwork network;
+    network.initialize(numNeurons, benchmarkSeed);
+    const TrainingSet samples = randomSamples(batchSize);
+
+    PerfCounters perf;
+    perf.open();
+
+    perf.start();
+    for (auto _ : state) {
+        for (const auto& sample : samples) {
+            benchmark::DoNotOptimize(network.computeOutput(sample.first.first, sample.first.second));
+        }
+    }
+    perf.stop();
+    setCounters(state, batchSize, forwardFlops);
+    setPerfCounters(state, perf, batchSize);
+}
+
+void BM_Gradient(benchmark::State& state)
+{
+    const int numNeurons = static_cast<int>(state.range(0));
+    const int batchSize = static_cast<int>(state.range(1));
+    RRBFNetwork network;
+    network.initialize(numNeurons, benchmarkSeed);
+    const TrainingSet samples = randomSamples(batchSize);
+    QVector<double> grad_weights, grad_stdDevs, grad_centers;
+
+    PerfCounters perf;
+    perf.open();
+
+    perf.start();
+    for (auto _ : state) {
+        for (const auto& sample : samples) {
+            network.computeGradients(sample.first.first, sample.first.second, sample.second,
+                                     grad_weights, grad_stdDevs, grad_centers);
+            benchmark::DoNotOptimize(grad_weights.data());
+        }
+    }
+    perf.stop();
+    setCounters(state, batchSize, gradientFlops);
+    setPerfCounters(state, perf, batchSize);
+}
+
+void BM_Update(benchmark::State& state)
+{
+    const int numNeurons = static_cast<int>(state.range(0));
+    const int batchSize = static_cast<int>(state.range(1));
+    RRBFNetwork network;
+    network.initialize(numNeurons, benchmarkSeed);
+    QVector<double> grad_weights(numNeurons, 1e-9), grad_stdDevs(numNeurons, 1e-9), grad_centers(numNeurons, 1e-9);
+
+    for (auto _ : state) {
+        for (int b = 0; b < batchSize; ++b) {
+            network.updateParameters(grad_weights, grad_stdDevs, grad_centers, 0.002);
+        }
+        benchmark::ClobberMemory();
+    }
+    const double samples = static_cast<double>(batchSize) * state.iterations();
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["ns_per_sample"] = benchmark::Counter(samples * 1e-9,
+                                                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["GFLOP/s"] = benchmark::Counter(updateFlops * numNeurons * samples * 1e-9,
+                                                   benchmark::Counter::kIsRate);
+}
+
+// RRBFPredictor with and without culling, stdDevs scaled by sigma_pct / 100
+// to get narrow neurons, tol_exp 0 = dense, n = tolerance 1e-n
+void BM_PredictCulled(benchmark::State& state)
+{
+    const int numNeurons = static_cast<int>(state.range(0));
+    const double sigmaScale = state.range(1) / 100.0;
+    const int toleranceExponent = static_cast<int>(state.range(2));
+    const int batchSize = 1024;
+
+    RRBFNetwork network;
+    network.initialize(numNeurons, benchmarkSeed);
+    for (double& stdDev : network.stdDevs) stdDev *= sigmaScale;
+    RRBFPredictor predictor(network);
+    if (toleranceExponent > 0) predictor.enableCulling(std::pow(10.0, -toleranceExponent));
+
+    const TrainingSet samples = randomSamples(batchSize);
+    std::vector<double> xs(batchSize), ys(batchSize), outputs(batchSize);
+    for (int s = 0; s < batchSize; ++s) {
+        xs[s] = samples[s].first.first;
+        ys[s] = samples[s].first.second;
+    }
+
+    for (auto _ : state) {
+        predictor.predict(xs.data(), ys.data(), outputs.data(), batchSize);
+        benchmark::DoNotOptimize(outputs.data());
+    }
+    const double count = static_cast<double>(batchSize) * state.iterations();
+    state.SetItemsProcessed(static_cast<int64_t>(count));
+    state.counters["ns_per_sample"] = benchmark::Counter(count * 1e-9,
+                                                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["evaluated"] = predictor.culledFraction(xs.data(), ys.data(), batchSize);
+}
+
+// gradient and prediction cost of the basis functions (basis.h), stdDevs
+// from the default random init
+void BM_Basis(benchmark::State& state)
+{
+    const int numNeurons = static_cast<int>(state.range(0));
+    const int batchSize = 1024;
+    RRBFNetwork network;
+    network.initialize(numNeurons, benchmarkSeed);
+    network.basis = static_cast<BasisFunction>(state.range(1));
+    RRBFPredictor predictor(network);
+
+    const TrainingSet samples = randomSamples(batchSize);
+    std::vector<double> xs(batchSize), ys(batchSize), outputs(batchSize);
+    for (int s = 0; s < batchSize; ++s) {
+        xs[s] = samples[s].first.first;
+        ys[s] = samples[s].first.second;
+    }
+    QVector<double> grad_weights, grad_stdDevs, grad_centers;
+
+    double gradientNs = 0.0, predictNs = 0.0;
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& sample : samples) {
+            network.computeGradients(sample.first.first, sample.first.second, sample.second,
+                                     grad_weights, grad_stdDevs, grad_centers);
+            benchmark::DoNotOptimize(grad_weights.data());
+        }
+        auto middle = std::chrono::steady_clock::now();
+        predictor.predict(xs.data(), ys.data(), outputs.data(), batchSize);
+        benchmark::DoNotOptimize(outputs.data());
+        auto end = std::chrono::steady_clock::now();
+        gradientNs += std::chrono::duration<double, std::nano>(middle - start).count();
+        predictNs += std::chrono::duration<double, std::nano>(end - middle).count();
+    }
+    const double terms = static_cast<double>(batchSize) * numNeurons * state.iterations();
+    state.SetItemsProcessed(static_cast<int64_t>(batchSize * state.iterations()));
+    state.SetLabel(RRBFNetwork::basisName(network.basis).toStdString());
+    state.counters["gradient_ns_per_neuron"] = gradientNs / terms;
+    state.counters["predict_ns_per_neuron"] = predictNs / terms;
+}
+
+// one RRBFTrainer::trainStep() as the GUI runs it: gradient and update for
+// one sample followed by the full error pass over the batch (= data set)
+void BM_TrainStep(benchmark::State& state)
+{
+    const int numNeurons = static_cast<int>(state.range(0));
+    const int batchSize = static_cast<int>(state.range(1));
+    const TrainingSet samples = randomSamples(batchSize);
+    RRBFNetwork network;
+    RRBFTrainer trainer(network, samples);
+    TrainingOptions options;
+    options.numNeurons = numNeurons;
+    options.seed = benchmarkSeed;
+    trainer.start(options);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(trainer.trainStep());
+    }
+
+    const double steps = static_cast<double>(state.iterations());
+    const double flopsPerStep = (gradientFlops + updateFlops + forwardFlops * batchSize) * numNeurons;
+    state.SetItemsProcessed(static_cast<int64_t>(steps));
+    state.counters["ns_per_step"] = benchmark::Counter(steps * 1e-9,
+                                                       benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["exps_per_s"] = benchmark::Counter(2.0 * numNeurons * (1 + batchSize) * steps,
+                                                      benchmark::Counter::kIsRate);
+    state.counters["GFLOP/s"] = benchmark::Counter(flopsPerStep * steps * 1e-9, benchmark::Counter::kIsRate);
+}
+
+// one epoch of MultiModelTrainer (per-sample SGD plus the error evaluation)
+// on models copies of a network; models = 1 is the cost of a single model
+void BM_MultiModelEpoch(benchmark::State& state)
+{
+    const int numNeurons = static_cast<int>(state.range(0));
+    const int models = static_cast<int>(state.range(1));
+    const TrainingSet samples = RRBFNetwork::createTrainingDataSet();
+
+    QVector<TrainingOptions> options(models);
+    for (int m = 0; m < models; ++m) {
+        options[m].numNeurons = numNeurons;
+        options[m].seed = benchmarkSeed + m;
+        options[m].stopCondition = 0.0;
+    }
+    MultiModelTrainer trainer(samples);
+    trainer.start(options);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(trainer.trainStep());
+    }
+    const double modelSamples = static_cast<double>(samples.size()) * models * state.iterations();
+    state.counters["ns_per_model_sample"] = benchmark::Counter(modelSamples * 1e-9,
+                                                               benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// wall time until the training error drops below 0.01 with threads Hogwild
+// workers; threads = 1 is single-threaded SGD on the same random samples.
+// The error of a snapshot is checked every millisecond, at most 30 s.
+void BM_HogwildTimeToError(benchmark::State& state)
+{
+    const int numNeurons = static_cast<int>(state.range(0));
+    const int threads = static_cast<int>(state.range(1));
+    const double targetError = 0.01;
+    const TrainingSet samples = RRBFNetwork::createTrainingDataSet();
+
+    long long updates = 0;
+    double startError = 0.0, finalError = 0.0, seconds = 0.0;
+    int reached = 0;
+    for (auto _ : state) {
+        RRBFNetwork network;
+        network.initialize(numNeurons, benchmarkSeed);
+        startError = network.computeError(samples);
+        HogwildTrainer hogwild(network, samples);
+
+        auto start = std::chrono::steady_clock::now();
+        hogwild.start(threads, 0.002, benchmarkSeed);
+        double error = startError;
+        while (error >= targetError && std::chrono::steady_clock::now() - start < std::chrono::seconds(30)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            error = hogwild.computeError();
+        }
+        updates += hogwild.updateCount();
+        hogwild.stop();
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        finalError = network.computeError(samples);
+        if (error < targetError) reached++;
+    }
+    state.counters["updates_per_s"] = updates / seconds;
+    state.counters["error_per_s"] = (startError - finalError) * state.iterations() / seconds;
+    state.counters["reached"] = static_cast<double>(reached) / state.iterations();
+}
+
+void neuronAndBatchSweep(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"neurons", "batch"});
+    for (int neurons : {16, 64, 256, 1024, 4096}) {
+        for (int batch : {1, 169, 1024}) {
+            benchmark->Args({neurons, batch});
+        }
+    }
+}
+
+}
+
+BENCHMARK(BM_Forward)->Apply(neuronAndBatchSweep);
+BENCHMARK(BM_Gradient)->Apply(neuronAndBatchSweep);
+BENCHMARK(BM_Update)->Apply(neuronAndBatchSweep);
+BENCHMARK(BM_TrainStep)->Apply(neuronAndBatchSweep);
+BENCHMARK(BM_PredictCulled)->ArgNames({"neurons", "sigma_pct", "tol_exp"})
+    ->ArgsProduct({{256, 1024, 4096}, {100, 10}, {0, 9, 6, 3}});
+BENCHMARK(BM_Basis)->ArgNames({"neurons", "basis"})
+    ->ArgsProduct({{64, 1024}, {GaussianSumBasis, RadialGaussianBasis, WendlandBasis, InverseMultiquadricBasis}});
+BENCHMARK(BM_MultiModelEpoch)->ArgNames({"neurons", "models"})
+    ->ArgsProduct({{16, 64, 256}, {1, 8, 32, 64}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HogwildTimeToError)->ArgNames({"neurons", "threads"})
+    ->ArgsProduct({{16, 64, 256}, {1, 2, 4, 8}})->Unit(benchmark::kMillisecond)->UseRealTime()->Iterations(3);
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--seed=", 7) == 0) {
+            benchmarkSeed = QByteArray(argv[i] + 7).toUInt();
+        }
+    }
+    benchmark::AddCustomContext("seed", std::to_string(benchmarkSeed));
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,401 @@
+#include "commandline.h"
+#include "compress.h"
+#include "harness.h"
+#include "hogwild.h"
+#include "loadgen.h"
+#include "metrics.h"
+#include "search.h"
+#include "server.h"
+#include "sizing.h"
+#include "predictor.h"
+#include "profiler.h"
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QDebug>
+#include <QThread>
+#include <vector>
+
+void addCommandLineOptions(QCommandLineParser& parser)
+{
+    parser.setApplicationDescription("RRBF Neural Network");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"headless", "Train without opening the window."},
+        {"neurons", "Number of neurons (default 16).", "n"},
+        {"learning-rate", "Learning rate (default 0.002).", "rate"},
+        {"stop-condition", "Stop training if error < value (default 0.001).", "error"},
+        {"max-steps", "Stop training after this many steps (default 0 = no limit).", "steps"},
+        {"seed", "Random seed for network initialization (default 0 = random).", "seed"},
+        {"init", "Center initialization: random or kmeans (default random).", "method"},
+        {"basis", "Basis function: rrbf, gaussian, wendland or imq (default rrbf).", "name"},
+        {"init-sigma", "Range of the random initial stdDevs (default 0.1:1).", "min:max"},
+        {"solve-weights", "Set the weights by least squares after initialization."},
+        {"solve-weights-every", "Re-solve the weights by least squares every n steps.", "n"},
+        {"optimizer", "sgd, momentum, nesterov, adam or rmsprop (default sgd).", "name"},
+        {"momentum", "Momentum coefficient, beta1 for adam (default 0.9).", "value"},
+        {"lr-schedule", "constant, step, exp, cosine or plateau (default constant).", "name"},
+        {"lr-period", "Steps per decay, first cosine cycle or plateau patience (default 1000).", "steps"},
+        {"lr-gamma", "Decay factor of the step, exp and plateau schedules (default 0.5).", "factor"},
+        {"lr-min", "Lowest learning rate, bottom of the cosine cycles (default 0).", "rate"},
+        {"lr-restart-mult", "Growth of the cosine cycle length per restart (default 2).", "factor"},
+        {"lr-scales", "Learning rate factors for weights, stdDevs and centers (default 1,1,1).", "w,s,m"},
+        {"sparse-threshold", "SGD: only train the neurons whose phi_x or phi_y exceeds this (default 0 = dense).", "value"},
+        {"grow", "Start with --neurons and add neurons at the worst sample when the error stalls, up to n.", "n"},
+        {"grow-every", "Steps between two growth checks (default one epoch).", "steps"},
+        {"grow-threshold", "Add a neuron when the error fell by less than this share since the last check (default 0.01).", "share"},
+        {"priority", "Draw training samples with probability ~ |residual|^alpha instead of in order (default 0 = off).", "alpha"},
+        {"priority-beta", "Importance weight exponent of --priority, 1 = unbiased, 0 = none (default 1).", "beta"},
+        {"hogwild", "Train with n lock-free asynchronous SGD threads on random samples.", "threads"},
+        {"lm", "Train with Levenberg-Marquardt iterations over the whole data set."},
+        {"validation-split", "Hold out this share of the samples for early stopping (default 0 = off).", "fraction"},
+        {"validation-every", "Evaluate the validation error every n steps (default 100).", "n"},
+        {"patience", "Stop after n evaluations without improvement (default 10, 0 = never).", "n"},
+        {"min-delta", "Smallest validation error decrease that counts as improvement (default 0).", "value"},
+        {"keep-last", "Do not restore the best validation model at the end."},
+        {"save-model", "Write the trained model to this file.", "file"},
+        {"epoch-report", "Print error, sparsity and gradient+update time after every epoch."},
+        {"profile", "Print the per-phase timing of the training loop when done."},
+        {"metrics-file", "Write training metrics in the Prometheus text format to this file.", "file"},
+        {"metrics-socket", "Serve training metrics in the Prometheus text format on this Unix socket.", "name"},
+        {"metrics-interval", "Milliseconds between two metrics updates (default 1000).", "ms"},
+        {"perf-counters", "Print hardware counters (cycles, IPC, cache and branch misses) of the gradient and error kernels (Linux)."},
+    });
+    addHarnessOptions(parser);
+    addServerOptions(parser);
+    addLoadGeneratorOptions(parser);
+    addSearchOptions(parser);
+    addSizingOptions(parser);
+    addCompressionOptions(parser);
+}
+
+TrainingOptions trainingOptionsFromParser(const QCommandLineParser& parser, TrainingOptions options)
+{
+    //only options given on the command line override the defaults
+    if (parser.isSet("neurons")) options.numNeurons = parser.value("neurons").toInt();
+    if (parser.isSet("learning-rate")) options.learningRate = parser.value("learning-rate").toDouble();
+    if (parser.isSet("stop-condition")) options.stopCondition = parser.value("stop-condition").toDouble();
+    if (parser.isSet("max-steps")) options.maxSteps = parser.value("max-steps").toLongLong();
+    if (parser.isSet("seed")) options.seed = parser.value("seed").toUInt();
+    if (parser.isSet("init")) {
+        options.initMethod = (parser.value("init") == "kmeans") ? TrainingOptions::InitKMeans
+                                                                : TrainingOptions::InitRandom;
+    }
+    if (parser.isSet("basis")) options.basis = RRBFNetwork::basisFromName(parser.value("basis"));
+    if (parser.isSet("init-sigma")) {
+        QStringList range = parser.value("init-sigma").split(':');
+        if (range.size() == 2) {
+            options.initStdDevMin = range[0].toDouble();
+            options.initStdDevMax = range[1].toDouble();
+        }
+    }
+    if (parser.isSet("solve-weights")) options.solveWeights = true;
+    if (parser.isSet("solve-weights-every")) options.solveWeightsInterval = parser.value("solve-weights-every").toInt();
+    if (parser.isSet("optimizer")) options.optimizer = RRBFOptimizer::typeFromName(parser.value("optimizer"));
+    if (parser.isSet("momentum")) options.momentum = parser.value("momentum").toDouble();
+    if (parser.isSet("lm")) options.levenbergMarquardt = true;
+    if (parser.isSet("lr-schedule")) options.schedule = LearningRateSchedule::typeFromName(parser.value("lr-schedule"));
+    if (parser.isSet("lr-period")) options.schedulePeriod = parser.value("lr-period").toInt();
+    if (parser.isSet("lr-gamma")) options.scheduleGamma = parser.value("lr-gamma").toDouble();
+    if (parser.isSet("lr-min")) options.minLearningRate = parser.value("lr-min").toDouble();
+    if (parser.isSet("lr-restart-mult")) options.restartMultiplier = parser.value("lr-restart-mult").toDouble();
+    if (parser.isSet("lr-scales")) {
+        QStringList scales = parser.value("lr-scales").split(',');
+        if (scales.size() == 3) {
+            options.weightsRateScale = scales[0].toDouble();
+            options.stdDevsRateScale = scales[1].toDouble();
+            options.centersRateScale = scales[2].toDouble();
+        }
+    }
+    if (parser.isSet("sparse-threshold")) options.sparseThreshold = parser.value("sparse-threshold").toDouble();
+    if (parser.isSet("grow")) options.growMaxNeurons = parser.value("grow").toInt();
+    if (parser.isSet("grow-every")) options.growInterval = parser.value("grow-every").toInt();
+    if (parser.isSet("grow-threshold")) options.growThreshold = parser.value("grow-threshold").toDouble();
+    if (parser.isSet("priority")) options.prioritySampling = parser.value("priority").toDouble();
+    if (parser.isSet("priority-beta")) options.priorityCorrection = parser.value("priority-beta").toDouble();
+    if (parser.isSet("batch-size")) options.batchSize = parser.value("batch-size").toInt();
+    if (parser.isSet("perf-counters")) options.perfCounters = true;
+    if (parser.isSet("validation-split")) options.validationFraction = parser.value("validation-split").toDouble();
+    if (parser.isSet("validation-every")) options.validationInterval = parser.value("validation-every").toInt();
+    if (parser.isSet("patience")) options.patience = parser.value("patience").toInt();
+    if (parser.isSet("min-delta")) options.minDelta = parser.value("min-delta").toDouble();
+    if (parser.isSet("keep-last")) options.restoreBest = false;
+    return options;
+}
+
+QStringList listValue(const QCommandLineParser& parser, const QString& name, const QString& defaultValue)
+{
+    QString value = parser.isSet(name) ? parser.value(name) : defaultValue;
+    return value.split(',', Qt::SkipEmptyParts);
+}
+
+bool checkOptions(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    bool ok = true;
+    if (parser.isSet("basis")) RRBFNetwork::basisFromName(parser.value("basis"), &ok);
+    if (!ok) {
+        out << "error: unknown --basis " << parser.value("basis") << ", use rrbf, gaussian, wendland or imq" << Qt::endl;
+        return false;
+    }
+    if (parser.isSet("optimizer")) {
+        //--harness and --search take a comma separated list
+        const bool list = parser.isSet("harness") || parser.isSet("search");
+        const QString value = parser.value("optimizer");
+        for (const QString& name : list ? value.split(',', Qt::SkipEmptyParts) : QStringList{ value }) {
+            RRBFOptimizer::typeFromName(name, &ok);
+            if (!ok) {
+                out << "error: unknown --optimizer " << name << ", use sgd, momentum, nesterov, adam or rmsprop" << Qt::endl;
+                return false;
+            }
+        }
+    }
+    if (parser.isSet("init") && parser.value("init") != "random" && parser.value("init") != "kmeans") {
+        out << "error: unknown --init " << parser.value("init") << ", use random or kmeans" << Qt::endl;
+        return false;
+    }
+    //the parts of value as numbers, false unless there are count of them
+    auto numbers = [](const QString& value, QChar separator, int count, QVector<double>& parts) -> bool {
+        const QStringList fields = value.split(separator);
+        if (fields.size() != count) return false;
+        parts.clear();
+        for (const QString& field : fields) {
+            bool isNumber = false;
+            parts.append(field.toDouble(&isNumber));
+            if (!isNumber) return false;
+        }
+        return true;
+    };
+    QVector<double> parts;
+    if (parser.isSet("init-sigma")) {
+        //--search takes a comma separated list of ranges, a single value there stands for value:value
+        const bool search = parser.isSet("search");
+        const QString value = parser.value("init-sigma");
+        for (const QString& range : search ? value.split(',', Qt::SkipEmptyParts) : QStringList{ value }) {
+            const bool valid = numbers(range, ':', 2, parts) || (search && numbers(range, ':', 1, parts));
+            if (!valid || parts.first() <= 0.0 || parts.first() > parts.last()) {
+                out << "error: --init-sigma needs min:max with 0 < min <= max, not " << range << Qt::endl;
+                return false;
+            }
+        }
+    }
+    //Adam divides by 1 - beta1^t, the momentum methods diverge at 1; the GUI caps it at 0.999 as well
+    if (parser.isSet("momentum") && (!numbers(parser.value("momentum"), ',', 1, parts) || parts.first() < 0.0
+                                     || parts.first() >= 1.0)) {
+        out << "error: --momentum needs a number in [0, 1), not " << parser.value("momentum") << Qt::endl;
+        return false;
+    }
+    if (parser.isSet("lr-scales") && !numbers(parser.value("lr-scales"), ',', 3, parts)) {
+        out << "error: --lr-scales needs three numbers w,s,m, not " << parser.value("lr-scales") << Qt::endl;
+        return false;
+    }
+    if (parser.isSet("lr-schedule")) LearningRateSchedule::typeFromName(parser.value("lr-schedule"), &ok);
+    if (!ok) {
+        out << "error: unknown --lr-schedule " << parser.value("lr-schedule") << ", use constant, step, exp, cosine or plateau" << Qt::endl;
+        return false;
+    }
+    //createTestDataSet() steps through [-3, 3] by it
+    if (parser.isSet("test-step")) {
+        const double step = parser.value("test-step").toDouble(&ok);
+        if (!ok || step <= 0.0) {
+            out << "error: --test-step needs a number > 0, not " << parser.value("test-step") << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+double nsPerPrediction(const RRBFNetwork& network, const TrainingSet& data)
+{
+    std::vector<double> xs, ys;
+    for (const auto& sample : data) {
+        xs.push_back(sample.first.first);
+        ys.push_back(sample.first.second);
+    }
+    return RRBFPredictor(network).nsPerPrediction(xs.data(), ys.data(), xs.size());
+}
+
+bool isHeadlessMode(int argc, char *argv[])
+{
+    const char* headlessModes[] = { "--headless", "--harness", "--serve", "--loadgen", "--search", "--min-neurons", "--compress" };
+    for (int i = 1; i < argc; ++i) {
+        for (const char* mode : headlessModes) {
+            //"--serve model.json" as well as "--serve=model.json"
+            const uint length = qstrlen(mode);
+            if (qstrncmp(argv[i], mode, length) == 0 && (argv[i][length] == '\0' || argv[i][length] == '=')) return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+// --prune / --merge after training, before the model is saved; either one
+// compresses: --merge alone merges and refits without pruning (tolerance 0),
+// --prune alone merges at the default 0.05. A --prune list as for --compress
+// only uses its first value
+void compressTrainedModel(const QCommandLineParser& parser, RRBFNetwork& network, const TrainingSet& data, QTextStream& out)
+{
+    if (!parser.isSet("prune") && !parser.isSet("merge")) return;
+    const double prune = parser.isSet("prune") ? parser.value("prune").split(',').first().toDouble() : 0.0;
+    const double merge = parser.isSet("merge") ? parser.value("merge").toDouble() : 0.05;
+    const int removed = network.compress(data, prune, merge);
+    out << QString("Compressed: %1 of %2 neurons removed, Error: %3").arg(removed).arg(removed + network.numNeurons)
+           .arg(network.computeError(data), 0, 'f', 6) << Qt::endl;
+}
+
+// --hogwild: the workers run freely, this thread only checks the error of a
+// snapshot every 10 ms against the stop condition and maxSteps (= updates)
+int runHogwild(const QCommandLineParser& parser, RRBFTrainer& trainer, RRBFNetwork& network)
+{
+    QTextStream out(stdout);
+    const TrainingOptions& options = trainer.options;
+    const int threads = qMax(1, parser.value("hogwild").toInt());
+
+    HogwildTrainer hogwild(network, trainer.trainingData);
+    QElapsedTimer timer;
+    timer.start();
+    hogwild.start(threads, options.learningRate, options.seed);
+
+    double error = hogwild.computeError();
+    qint64 reportedMs = 0;
+    while (error >= options.stopCondition && (options.maxSteps <= 0 || hogwild.updateCount() < options.maxSteps)) {
+        QThread::msleep(10);
+        error = hogwild.computeError();
+        if (timer.elapsed() - reportedMs >= 1000) {
+            reportedMs = timer.elapsed();
+            out << QString("%1 ms, Updates: %2, Error: %3").arg(reportedMs).arg(hogwild.updateCount())
+                   .arg(error, 0, 'f', 6) << Qt::endl;
+        }
+    }
+    const long long updates = hogwild.updateCount();
+    hogwild.stop();
+
+    const double seconds = qMax<qint64>(1, timer.elapsed()) / 1000.0;
+    out << QString("Finished after %1 updates on %2 threads (%3 ms, %4 updates/s), Error: %5").arg(updates).arg(threads)
+           .arg(timer.elapsed()).arg(updates / seconds, 0, 'f', 0).arg(network.computeError(trainer.trainingData), 0, 'f', 6)
+        << Qt::endl;
+
+    compressTrainedModel(parser, network, trainer.trainingData, out);
+    if (parser.isSet("save-model") && !network.save(parser.value("save-model"))) return 1;
+    return 0;
+}
+
+}
+
+int runHeadless(const QCommandLineParser& parser)
+{
+    if (parser.isSet("harness")) return runHarness(parser);
+    if (parser.isSet("serve")) return runServer(parser);
+    if (parser.isSet("loadgen")) return runLoadGenerator(parser);
+    if (parser.isSet("search")) return runSearch(parser);
+    if (parser.isSet("min-neurons")) return runSizing(parser);
+    if (parser.isSet("compress")) return runCompression(parser);
+
+    QTextStream out(stdout);
+
+    TrainingOptions options = trainingOptionsFromParser(parser);
+    if (options.numNeurons < 1) {
+        out << "error: --neurons must be at least 1" << Qt::endl;
+        return 1;
+    }
+
+    //the hogwild workers only get the learning rate, the rest would be ignored
+    if (parser.isSet("hogwild") && (!HogwildTrainer::supports(options) || parser.isSet("metrics-file")
+                                    || parser.isSet("metrics-socket"))) {
+        out << "error: --hogwild runs plain per-sample SGD at a constant rate, without --optimizer, --lr-scales, "
+               "--lr-schedule, --batch-size, --lm, --validation-split, --solve-weights-every, --sparse-threshold, "
+               "--grow, --priority, --perf-counters or metrics" << Qt::endl;
+        return 1;
+    }
+
+    TrainingSet trainingData = RRBFNetwork::createTrainingDataSet();
+    RRBFNetwork network;
+    RRBFTrainer trainer(network, trainingData);
+
+    MetricsExporter metrics;
+    if (parser.isSet("metrics-file")) metrics.setFile(parser.value("metrics-file"));
+    if (parser.isSet("metrics-socket") && !metrics.listen(parser.value("metrics-socket"))) {
+        out << "error: cannot listen on " << parser.value("metrics-socket") << ": " << metrics.errorString() << Qt::endl;
+        return 1;
+    }
+    if (parser.isSet("metrics-interval")) metrics.intervalMs = parser.value("metrics-interval").toInt();
+
+    trainer.start(options);
+    out << "seed: " << trainer.options.seed << Qt::endl;
+    if (parser.isSet("hogwild")) return runHogwild(parser, trainer, network);
+
+    const bool epochReport = parser.isSet("epoch-report");
+    int reportedEpoch = 0;
+    qint64 reportedSteps = 0, reportedNs = 0;
+
+    while (!trainer.isFinished()) {
+        trainer.trainStep();
+        metrics.maybePublish(trainer, network);
+        if (epochReport && trainer.epochCounter != reportedEpoch) {
+            //gradient+update time of this epoch from the profiler totals
+            qint64 counts[PhaseCount], totalNs[PhaseCount];
+            Profiler::totals(counts, totalNs);
+            qint64 ns = totalNs[PhaseGradient] + totalNs[PhaseUpdate];
+            qint64 steps = trainer.stepCounter - reportedSteps;
+            QString line = QString("Epoch: %1, Error: %2").arg(trainer.epochCounter).arg(trainer.totalError, 0, 'f', 6);
+            if (options.growMaxNeurons > 0) line += QString(", neurons: %1").arg(network.numNeurons);
+            if (trainer.usesSparseGradients()) line += QString(", active: %1%").arg(100.0 * trainer.activeFraction, 0, 'f', 1);
+            if (Profiler::isEnabled() && steps > 0) {
+                line += QString(", gradient+update: %1 us/step").arg((ns - reportedNs) / 1000.0 / steps, 0, 'f', 2);
+            }
+            out << line << Qt::endl;
+            reportedEpoch = trainer.epochCounter;
+            reportedSteps = trainer.stepCounter;
+            reportedNs = ns;
+        }
+        if (trainer.stepCounter % 1000 == 0) {
+            out << QString("Step: %1, Epoch: %2, Error: %3").arg(trainer.stepCounter)
+                   .arg(trainer.epochCounter).arg(trainer.totalError, 0, 'f', 6) << Qt::endl;
+        }
+    }
+    out << QString("Finished after %1 steps (%2 ms), Epoch: %3, Error: %4").arg(trainer.stepCounter)
+           .arg(trainer.elapsedMs()).arg(trainer.epochCounter).arg(trainer.totalError, 0, 'f', 6) << Qt::endl;
+    if (trainer.usesSparseGradients()) {
+        out << QString("Sparse gradients: %1% of the neurons active in the last epoch (threshold %2)")
+               .arg(100.0 * trainer.activeFraction, 0, 'f', 1).arg(options.sparseThreshold) << Qt::endl;
+    }
+    if (options.growMaxNeurons > 0) {
+        out << QString("Grown: %1 neurons added, %2 in total (limit %3)").arg(trainer.neuronsAdded)
+               .arg(network.numNeurons).arg(options.growMaxNeurons) << Qt::endl;
+    }
+    if (trainer.rejectedSteps > 0) {
+        out << QString("Levenberg-Marquardt: %1 iterations found no improving step, damping %2")
+               .arg(trainer.rejectedSteps).arg(trainer.lmDamping) << Qt::endl;
+    }
+    if (trainer.failedSolves > 0) {
+        out << QString("Least squares: %1 weight solves failed, the previous weights were kept")
+               .arg(trainer.failedSolves) << Qt::endl;
+    }
+    if (!trainer.validationData.isEmpty()) {
+        out << QString("Validation error: %1 (%2 samples), best %3 at step %4%5").arg(trainer.validationError, 0, 'f', 6)
+               .arg(trainer.validationData.size()).arg(trainer.bestValidationError, 0, 'f', 6)
+               .arg(trainer.bestValidationStep).arg(trainer.earlyStopped ? ", stopped early" : "") << Qt::endl;
+    }
+    metrics.publish(trainer, network);
+
+    if (parser.isSet("profile")) out << Profiler::report() << Qt::endl;
+
+    if (options.perfCounters) {
+        if (trainer.perfCountersAvailable()) {
+            //per sample: the gradient kernel sees batchSize samples per step, the error pass the
+            //samples trained on, without the ones held out by --validation-split
+            double gradientSamples = static_cast<double>(trainer.stepCounter) * qMax(1, options.batchSize);
+            double forwardSamples = static_cast<double>(trainer.stepCounter) * trainer.trainingData.size();
+            out << "gradient: " << PerfCounters::format(trainer.gradientCounters(), gradientSamples, "sample") << Qt::endl;
+            out << "forward:  " << PerfCounters::format(trainer.forwardCounters(), forwardSamples, "sample") << Qt::endl;
+        } else {
+            out << "perf counters unavailable: " << trainer.perfCountersError() << Qt::endl;
+        }
+    }
+
+    compressTrainedModel(parser, network, trainer.trainingData, out);
+
+    if (parser.isSet("save-model") && !network.save(parser.value("save-model"))) return 1;
+    return 0;
+}
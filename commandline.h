@@ -0,0 +1,27 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include <QCommandLineParser>
+#include "rrbftrainer.h"
+
+// command line options shared by the GUI and the headless modes
+void addCommandLineOptions(QCommandLineParser& parser);
+TrainingOptions trainingOptionsFromParser(const QCommandLineParser& parser,
+                                          TrainingOptions options = TrainingOptions());
+// the comma separated values of a --harness, --loadgen or --compress list
+// option, defaultValue when it is not given
+QStringList listValue(const QCommandLineParser& parser, const QString& name, const QString& defaultValue);
+
+// false after printing an error if an option has an unknown name or an
+// invalid number, trainingOptionsFromParser() would fall back to the default
+bool checkOptions(const QCommandLineParser& parser);
+
+// forward cost of one sample through RRBFPredictor, as the server runs the
+// model, timed over the inputs of data
+double nsPerPrediction(const RRBFNetwork& network, const TrainingSet& data);
+
+// true if argv asks for a mode that runs without a window
+bool isHeadlessMode(int argc, char *argv[]);
+int runHeadless(const QCommandLineParser& parser);
+
+#endif // COMMANDLINE_H
@@ -0,0 +1,57 @@
+#include "compress.h"
+#include "commandline.h"
+
+#include <QTextStream>
+
+void addCompressionOptions(QCommandLineParser& parser)
+{
+    parser.addOptions({
+        {"compress", "Prune and merge the neurons of this trained model and report error and latency.", "file"},
+        {"prune", "Drop neurons whose RMS output contribution is below this (default 0,1e-4,1e-3,1e-2). "
+                  "After --headless training: compress the trained model with the first value.", "tolerance"},
+        {"merge", "Merge neurons whose centers and stdDevs differ by less than this share of the stdDev (default 0.05). "
+                  "After --headless training: compress the trained model, without pruning unless --prune is given.", "tolerance"},
+    });
+}
+
+int runCompression(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+
+    RRBFNetwork original;
+    if (!original.load(parser.value("compress"))) {
+        out << "error: cannot load " << parser.value("compress") << Qt::endl;
+        return 1;
+    }
+    QStringList tolerances = listValue(parser, "prune", "0,1e-4,1e-3,1e-2");
+    const double merge = parser.isSet("merge") ? parser.value("merge").toDouble() : 0.05;
+
+    const TrainingSet trainingData = RRBFNetwork::createTrainingDataSet();
+    const double testStep = parser.isSet("test-step") ? parser.value("test-step").toDouble() : 0.1;
+    const TrainingSet testData = RRBFNetwork::createTestDataSet(testStep);
+
+    //accuracy / latency trade-off, the first row is the model as loaded
+    QStringList header = { "prune", "merge", "neurons", "train_error", "test_error", "ns/prediction" };
+    for (const QString& column : header) out << column.leftJustified(14);
+    out << Qt::endl;
+    auto print = [&](const QString& prune, const QString& mergeValue, const RRBFNetwork& network) {
+        QStringList row = { prune, mergeValue, QString::number(network.numNeurons),
+                            QString::number(network.computeError(trainingData), 'f', 6),
+                            QString::number(network.computeError(testData), 'f', 6),
+                            QString::number(nsPerPrediction(network, testData), 'f', 1) };
+        for (const QString& value : row) out << value.leftJustified(14);
+        out << Qt::endl;
+    };
+    print("-", "-", original);
+
+    RRBFNetwork compressed;
+    for (const QString& tolerance : tolerances) {
+        compressed = original;
+        compressed.compress(trainingData, tolerance.toDouble(), merge);
+        print(tolerance, QString::number(merge), compressed);
+    }
+
+    //the model of the last tolerance
+    if (parser.isSet("save-model") && !compressed.save(parser.value("save-model"))) return 1;
+    return 0;
+}
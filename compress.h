@@ -0,0 +1,13 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <QCommandLineParser>
+
+// headless post-training compression of a saved model: RRBFNetwork::compress()
+// for every comma separated --prune tolerance, printed as a table of neuron
+// count, train and test error and prediction latency; --save-model writes
+// the model of the last tolerance
+void addCompressionOptions(QCommandLineParser& parser);
+int runCompression(const QCommandLineParser& parser);
+
+#endif // COMPRESS_H
@@ -0,0 +1,89 @@
+#include "rrbftrainer.h"
+
+#include <limits>
+
+// Constructive training in the style of a resource allocating network. The
+// run starts with options.numNeurons neurons; whenever the training error
+// fell by less than growThreshold over the last check interval, one neuron
+// is inserted at the sample with the largest residual, and its weight
+// cancels the residual at the sample. For GaussianSumBasis the center is the
+// x or y coordinate of that sample, whichever is farther from the existing
+// centers, and the stdDev the distance to the nearest center. The radial
+// bases are centered at (m, m), there m is the point of the diagonal nearest
+// to the sample and the stdDev at least twice the sample's distance to it,
+// so that the kernel covers the sample (phi >= 0.18 for Wendland). The other
+// parameters and their optimizer state are kept, so training continues
+// where it stalled.
+
+void RRBFNetwork::addNeuron(double center, double stdDev, double weight)
+{
+    centers.append(center);
+    stdDevs.append(stdDev);
+    weights.append(weight);
+    numNeurons = centers.size();
+}
+
+void RRBFTrainer::growNetwork()
+{
+    const qint64 interval = options.growInterval > 0 ? options.growInterval
+                                                     : qMax(1, trainingData.size() / samplesPerStep());
+    if (stepCounter % interval != 0) return;
+
+    const bool stalled = totalError > growCheckError * (1.0 - options.growThreshold);
+    growCheckError = totalError;
+    if (!stalled || network.numNeurons >= options.growMaxNeurons) return;
+
+    int worst = 0;
+    double worstResidual = 0.0;
+    for (int j = 0; j < trainingData.size(); ++j) {
+        const auto& sample = trainingData[j];
+        double residual = sample.second - network.computeOutput(sample.first.first, sample.first.second);
+        if (qAbs(residual) > qAbs(worstResidual)) {
+            worst = j;
+            worstResidual = residual;
+        }
+    }
+    if (worstResidual == 0.0) return;
+
+    const double x = trainingData[worst].first.first;
+    const double y = trainingData[worst].first.second;
+    auto distance = [this](double value) {
+        double nearest = std::numeric_limits<double>::infinity();
+        for (double center : network.centers) nearest = qMin(nearest, qAbs(value - center));
+        return nearest;
+    };
+    double center, stdDev;
+    if (network.basis == GaussianSumBasis) {
+        //the coordinate of the sample that is less covered by the existing centers
+        const double distanceX = distance(x), distanceY = distance(y);
+        const double nearest = qMax(distanceX, distanceY);
+        center = distanceX >= distanceY ? x : y;
+        stdDev = qIsFinite(nearest) && nearest > 0.0 ? qMax(0.001, nearest) : 1.0;
+    } else {
+        //(m, m) nearest to the sample, the centers are sqrt(2) |m - c| apart
+        center = 0.5 * (x + y);
+        const double offset = qAbs(x - y) / M_SQRT2;
+        const double nearest = M_SQRT2 * distance(center);
+        stdDev = qMax(qIsFinite(nearest) && nearest > 0.0 ? nearest : 1.0, qMax(0.001, 2.0 * offset));
+    }
+
+    network.addNeuron(center, stdDev, 0.0);
+    const int added = network.numNeurons - 1;
+    const double phi = network.computePhi(added, x, y);
+    if (phi < 1e-6) {
+        //no weight can cancel the residual, leave the network as it is
+        network.numNeurons--;
+        network.centers.removeLast();
+        network.stdDevs.removeLast();
+        network.weights.removeLast();
+        return;
+    }
+    network.weights[added] = worstResidual / phi;
+    optimizer.resize(network.numNeurons);
+    neuronsAdded++;
+
+    totalError = network.computeError(trainingData);
+    bestError = qMin(bestError, totalError);
+    growCheckError = totalError;
+    if (options.prioritySampling > 0.0) resetPriorities();
+}
@@ -0,0 +1,168 @@
+#include "harness.h"
+#include "multimodel.h"
+#include "rrbftrainer.h"
+#include "commandline.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+struct HarnessResult
+{
+    TrainingOptions options;
+    bool reached;
+    qint64 timeMs;
+    qint64 steps;
+    int epochs;
+    double trainError;
+    double testError;
+};
+
+}
+
+void addHarnessOptions(QCommandLineParser& parser)
+{
+    parser.addOptions({
+        {"harness", "Run the time-to-accuracy harness (list options take comma separated values)."},
+        {"batch-size", "Samples averaged per gradient step (default 1).", "n"},
+        {"multi-model", "Train all SGD runs of the harness together in one interleaved pass."},
+        {"test-step", "Grid step of the test error (default 0.1).", "step"},
+        {"csv", "Write the harness results to this CSV file.", "file"},
+    });
+}
+
+int runHarness(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+
+    //single valued options (stop condition, init, ...) are shared by all runs
+    TrainingOptions base = trainingOptionsFromParser(parser, TrainingOptions());
+    if (!parser.isSet("max-steps")) base.maxSteps = 200000; //unreachable targets must end
+
+    QStringList neurons = listValue(parser, "neurons", "16");
+    QStringList learningRates = listValue(parser, "learning-rate", "0.002");
+    QStringList optimizers = listValue(parser, "optimizer", "sgd");
+    QStringList batchSizes = listValue(parser, "batch-size", "1");
+    QStringList seeds = listValue(parser, "seed", "1");
+    double testStep = parser.isSet("test-step") ? parser.value("test-step").toDouble() : 0.1;
+
+    const TrainingSet trainingData = RRBFNetwork::createTrainingDataSet();
+    const TrainingSet testData = RRBFNetwork::createTestDataSet(testStep);
+
+    QVector<TrainingOptions> runs;
+    for (const QString& n : neurons) {
+        for (const QString& rate : learningRates) {
+            for (const QString& optimizer : optimizers) {
+                for (const QString& batch : batchSizes) {
+                    for (const QString& seed : seeds) {
+                        TrainingOptions options = base;
+                        options.numNeurons = n.toInt();
+                        options.learningRate = rate.toDouble();
+                        options.optimizer = RRBFOptimizer::typeFromName(optimizer);
+                        options.batchSize = batch.toInt();
+                        options.seed = seed.toUInt();
+                        runs.append(options);
+                    }
+                }
+            }
+        }
+    }
+
+    QVector<HarnessResult> results;
+    auto report = [&out](const HarnessResult& result) {
+        const TrainingOptions& options = result.options;
+        out << QString("neurons %1, rate %2, %3, batch %4, seed %5: %6 ms, %7 steps, error %8")
+               .arg(options.numNeurons).arg(options.learningRate).arg(RRBFOptimizer::typeName(options.optimizer))
+               .arg(options.batchSize).arg(options.seed).arg(result.timeMs).arg(result.steps)
+               .arg(result.trainError, 0, 'f', 6) << Qt::endl;
+    };
+
+    if (parser.isSet("multi-model")) {
+        //the interleaved trainer only does per-sample SGD at a constant rate
+        QVector<TrainingOptions> sgdRuns;
+        for (const TrainingOptions& options : runs) {
+            if (MultiModelTrainer::supports(options)) sgdRuns.append(options);
+        }
+        if (sgdRuns.size() != runs.size()) {
+            out << QString("multi-model: skipping %1 runs that are not per-sample SGD at a constant rate")
+                   .arg(runs.size() - sgdRuns.size()) << Qt::endl;
+        }
+
+        MultiModelTrainer trainer(trainingData);
+        trainer.start(sgdRuns);
+        while (!trainer.isFinished()) trainer.trainStep();
+
+        for (int m = 0; m < trainer.modelCount(); ++m) {
+            RRBFNetwork network;
+            trainer.network(m, network);
+            HarnessResult result;
+            result.options = trainer.options[m];
+            result.reached = trainer.errors[m] < result.options.stopCondition;
+            result.timeMs = trainer.finishedMs[m];
+            result.steps = trainer.steps[m];
+            result.epochs = static_cast<int>(trainer.steps[m] / trainingData.size());
+            result.trainError = trainer.errors[m];
+            result.testError = network.computeError(testData);
+            results.append(result);
+            report(result);
+        }
+        out << QString("multi-model: %1 models in %2 ms, errors checked once per epoch")
+               .arg(trainer.modelCount()).arg(trainer.elapsedMs()) << Qt::endl;
+    } else {
+        for (const TrainingOptions& options : runs) {
+            RRBFNetwork network;
+            RRBFTrainer trainer(network, trainingData);
+            trainer.start(options);
+            while (!trainer.isFinished()) trainer.trainStep();
+
+            HarnessResult result;
+            result.options = trainer.options;
+            result.reached = trainer.totalError < options.stopCondition;
+            result.timeMs = trainer.elapsedMs();
+            result.steps = trainer.stepCounter;
+            result.epochs = trainer.epochCounter;
+            result.trainError = trainer.totalError;
+            result.testError = network.computeError(testData);
+            results.append(result);
+            report(result);
+        }
+    }
+
+    //comparison table, fastest successful run first
+    std::stable_sort(results.begin(), results.end(), [](const HarnessResult& a, const HarnessResult& b) {
+        if (a.reached != b.reached) return a.reached;
+        return a.reached ? a.timeMs < b.timeMs : a.trainError < b.trainError;
+    });
+
+    QStringList header = { "neurons", "learning_rate", "optimizer", "batch_size", "seed", "reached",
+                           "time_ms", "steps", "epochs", "train_error", "test_error" };
+    auto row = [](const HarnessResult& r) {
+        return QStringList{ QString::number(r.options.numNeurons), QString::number(r.options.learningRate),
+                            RRBFOptimizer::typeName(r.options.optimizer), QString::number(r.options.batchSize),
+                            QString::number(r.options.seed), r.reached ? "yes" : "no",
+                            QString::number(r.timeMs), QString::number(r.steps), QString::number(r.epochs),
+                            QString::number(r.trainError, 'f', 6), QString::number(r.testError, 'f', 6) };
+    };
+
+    out << Qt::endl << QString("Stop condition: error < %1, test grid step %2").arg(base.stopCondition).arg(testStep) << Qt::endl;
+    for (const QString& column : header) out << column.leftJustified(14);
+    out << Qt::endl;
+    for (const HarnessResult& r : results) {
+        for (const QString& value : row(r)) out << value.leftJustified(14);
+        out << Qt::endl;
+    }
+
+    if (parser.isSet("csv")) {
+        QFile file(parser.value("csv"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            out << "error: cannot write " << parser.value("csv") << Qt::endl;
+            return 1;
+        }
+        QTextStream csv(&file);
+        csv << header.join(',') << '\n';
+        for (const HarnessResult& r : results) csv << row(r).join(',') << '\n';
+    }
+    return 0;
+}
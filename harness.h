@@ -0,0 +1,13 @@
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include <QCommandLineParser>
+
+// headless time-to-accuracy runs over every combination of the comma
+// separated --neurons, --learning-rate, --optimizer, --batch-size and --seed
+// values, printed as a table and optionally written as CSV; --multi-model
+// trains the per-sample SGD runs together in one MultiModelTrainer pass
+void addHarnessOptions(QCommandLineParser& parser);
+int runHarness(const QCommandLineParser& parser);
+
+#endif // HARNESS_H
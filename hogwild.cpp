@@ -0,0 +1,151 @@
+#include "hogwild.h"
+
+HogwildTrainer::HogwildTrainer(RRBFNetwork& network_, const TrainingSet& data_)
+    : network(network_)
+    , data(data_)
+{
+    learningRate = 0.0;
+    numNeurons = 0;
+    basis = GaussianSumBasis;
+    running = false;
+}
+
+HogwildTrainer::~HogwildTrainer()
+{
+    stop();
+}
+
+bool HogwildTrainer::supports(const TrainingOptions& options)
+{
+    return options.optimizer == RRBFOptimizer::SGD && options.weightsRateScale == 1.0
+           && options.stdDevsRateScale == 1.0 && options.centersRateScale == 1.0
+           && options.schedule == LearningRateSchedule::Constant && options.batchSize <= 1
+           && !options.levenbergMarquardt && options.validationFraction <= 0.0
+           && options.solveWeightsInterval <= 0 && options.sparseThreshold <= 0.0
+           && options.growMaxNeurons <= 0 && options.prioritySampling <= 0.0 && !options.perfCounters;
+}
+
+void HogwildTrainer::start(int threads, double learningRate_, quint32 seed)
+{
+    stop();
+    if (data.isEmpty()) return;
+
+    learningRate = learningRate_;
+    numNeurons = network.numNeurons;
+    basis = network.basis;
+    weights.reset(new std::atomic<double>[numNeurons]);
+    stdDevs.reset(new std::atomic<double>[numNeurons]);
+    centers.reset(new std::atomic<double>[numNeurons]);
+    for (int i = 0; i < numNeurons; ++i) {
+        weights[i].store(network.weights[i], std::memory_order_relaxed);
+        stdDevs[i].store(network.stdDevs[i], std::memory_order_relaxed);
+        centers[i].store(network.centers[i], std::memory_order_relaxed);
+    }
+
+    threads = qMax(1, threads);
+    counters.reset(new WorkerCounter[threads]);
+    for (int t = 0; t < threads; ++t) counters[t].updates = 0;
+
+    //thread creation publishes the parameters to the workers
+    running = true;
+    void (HogwildTrainer::*worker)(int, quint32) = &HogwildTrainer::run<GaussianSumKernel>;
+    switch (basis) {
+    case RadialGaussianBasis: worker = &HogwildTrainer::run<RadialGaussianKernel>; break;
+    case WendlandBasis: worker = &HogwildTrainer::run<WendlandKernel>; break;
+    case InverseMultiquadricBasis: worker = &HogwildTrainer::run<InverseMultiquadricKernel>; break;
+    case GaussianSumBasis: break;
+    }
+    for (int t = 0; t < threads; ++t) workers.emplace_back(worker, this, t, seed);
+}
+
+void HogwildTrainer::stop()
+{
+    if (workers.empty()) return;
+    running = false;
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+    snapshot(network);
+}
+
+bool HogwildTrainer::isRunning() const
+{
+    return !workers.empty();
+}
+
+void HogwildTrainer::snapshot(RRBFNetwork& copy) const
+{
+    copy.numNeurons = numNeurons;
+    copy.seed = network.seed;
+    copy.basis = basis;
+    copy.weights.resize(numNeurons);
+    copy.stdDevs.resize(numNeurons);
+    copy.centers.resize(numNeurons);
+    for (int i = 0; i < numNeurons; ++i) {
+        copy.weights[i] = weights[i].load(std::memory_order_relaxed);
+        copy.stdDevs[i] = stdDevs[i].load(std::memory_order_relaxed);
+        copy.centers[i] = centers[i].load(std::memory_order_relaxed);
+    }
+}
+
+double HogwildTrainer::computeError() const
+{
+    if (!isRunning()) return network.computeError(data);
+    RRBFNetwork copy;
+    snapshot(copy);
+    return copy.computeError(data);
+}
+
+long long HogwildTrainer::updateCount() const
+{
+    long long total = 0;
+    for (int t = 0; t < threadCount(); ++t) total += counters[t].updates.load(std::memory_order_relaxed);
+    return total;
+}
+
+int HogwildTrainer::threadCount() const
+{
+    return static_cast<int>(workers.size());
+}
+
+template <class Kernel>
+void HogwildTrainer::run(int worker, quint32 seed)
+{
+    const quint32 seedBuffer[3] = { seed, 0x4096u, static_cast<quint32>(worker) };
+    QRandomGenerator rng(seedBuffer);
+
+    //the parameters as read by the forward pass, the gradient is computed from them
+    std::vector<double> w(numNeurons), phi(numNeurons), dStdDev(numNeurons), dCenter(numNeurons);
+    std::atomic<long long>& updates = counters[worker].updates;
+
+    while (running.load(std::memory_order_relaxed)) {
+        const auto& sample = data[rng.bounded(data.size())];
+        const double x = sample.first.first;
+        const double y = sample.first.second;
+
+        double output = 0.0;
+        for (int i = 0; i < numNeurons; ++i) {
+            w[i] = weights[i].load(std::memory_order_relaxed);
+            const double s = stdDevs[i].load(std::memory_order_relaxed);
+            const double m = centers[i].load(std::memory_order_relaxed);
+            phi[i] = Kernel::gradients(x - m, y - m, s, dStdDev[i], dCenter[i]);
+            output += w[i] * phi[i];
+        }
+        const double error = sample.second - output;
+
+        //same gradient as computeGradients(), subtracted from the current value
+        for (int i = 0; i < numNeurons; ++i) {
+            const double grad_weight = -error * phi[i];
+            const double grad_stdDev = -error * w[i] * dStdDev[i];
+            const double grad_center = -error * w[i] * dCenter[i];
+
+            //lost updates between workers are accepted, see hogwild.h
+            weights[i].store(weights[i].load(std::memory_order_relaxed) - learningRate * grad_weight,
+                             std::memory_order_relaxed);
+            stdDevs[i].store(qMax(0.001, stdDevs[i].load(std::memory_order_relaxed) - learningRate * grad_stdDev),
+                             std::memory_order_relaxed);
+            centers[i].store(centers[i].load(std::memory_order_relaxed) - learningRate * grad_center,
+                             std::memory_order_relaxed);
+        }
+        updates.store(updates.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
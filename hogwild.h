@@ -0,0 +1,76 @@
+#ifndef HOGWILD_H
+#define HOGWILD_H
+
+#include "rrbftrainer.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Asynchronous lock-free SGD (Hogwild). start() copies the network into
+// shared parameter arrays and starts the workers; each one draws random
+// samples with its own generator and applies plain SGD updates straight to
+// the shared arrays without any lock.
+//
+// Semantics of the races: every parameter is a std::atomic<double> read and
+// written with relaxed loads and stores, so no torn or out-of-thin-air
+// values, but no atomic read-modify-write either. A worker computes its
+// gradient from parameters that other workers may change half way through
+// and subtracts it from the value current at the time of the store; two
+// workers updating the same parameter at once can lose one of the updates
+// (last store wins). On x86 the relaxed operations compile to plain moves.
+// Every sample touches every neuron, so the more threads share the arrays,
+// the less progress a single update makes compared to sequential SGD.
+class HogwildTrainer
+{
+public:
+    HogwildTrainer(RRBFNetwork& network_, const TrainingSet& data_);
+    ~HogwildTrainer();
+
+    // threads workers from (seed, worker index), a stdDev never drops below
+    // 0.001 as in updateParameters()
+    void start(int threads, double learningRate, quint32 seed);
+    // joins the workers and writes the shared parameters back to the network
+    void stop();
+    bool isRunning() const;
+    // false for the options start() would ignore: anything but per-sample SGD
+    // at a constant rate on all the samples, i.e. other optimizers, rate
+    // scales, schedules, batches, LM, a validation split, periodic weight
+    // solves, sparse gradients, growing, prioritized sampling and perf counters
+    static bool supports(const TrainingOptions& options);
+
+    // current shared parameters, may mix updates that are still in flight
+    void snapshot(RRBFNetwork& copy) const;
+    double computeError() const; // of a snapshot, on the training data
+    long long updateCount() const; // samples applied by all workers since start()
+    int threadCount() const;
+
+private:
+    HogwildTrainer(const HogwildTrainer&) = delete;
+    HogwildTrainer& operator=(const HogwildTrainer&) = delete;
+
+    // padded to a cache line so that the workers never share one (padding
+    // instead of alignas, over-aligned new needs C++17)
+    struct WorkerCounter
+    {
+        std::atomic<long long> updates;
+        char padding[64 - sizeof(std::atomic<long long>)];
+    };
+
+    // one instance per basis function policy (basis.h)
+    template <class Kernel>
+    void run(int worker, quint32 seed);
+
+    RRBFNetwork& network;
+    const TrainingSet& data;
+    double learningRate;
+    int numNeurons;
+    BasisFunction basis;
+    std::unique_ptr<std::atomic<double>[]> weights, stdDevs, centers;
+    std::unique_ptr<WorkerCounter[]> counters;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running;
+};
+
+#endif // HOGWILD_H
@@ -0,0 +1,148 @@
+#include "rrbfnetwork.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+
+// RRBF centers are scalars shared by the x and the y term, so centers are
+// placed with a 1D k-means over all x and y coordinates of the data set
+
+namespace {
+
+struct KMeansChunk
+{
+    int begin;
+    int end;
+    QVector<double> sums;   // sum of points assigned to each center
+    QVector<int> counts;    // number of points assigned to each center
+    double cost;            // sum of squared distances to the nearest center
+};
+
+//index of the nearest center, sortedCenters must be sorted ascending
+int nearestCenter(const QVector<double>& sortedCenters, double value)
+{
+    auto it = std::lower_bound(sortedCenters.begin(), sortedCenters.end(), value);
+    int upper = static_cast<int>(it - sortedCenters.begin());
+    if (upper == sortedCenters.size()) return upper - 1;
+    if (upper == 0) return 0;
+    return (value - sortedCenters[upper - 1] <= sortedCenters[upper] - value) ? upper - 1 : upper;
+}
+
+}
+
+void RRBFNetwork::initializeKMeans(int numNeurons_, quint32 seed_, const TrainingSet& data,
+                                   int maxIterations, double sigmaScale)
+{
+    //weights are drawn the same way as initialize() does
+    initialize(numNeurons_, seed_);
+    if (data.isEmpty()) return;
+
+    QVector<double> points;
+    points.reserve(data.size() * 2);
+    for (const auto& sample : data) {
+        points.append(sample.first.first);
+        points.append(sample.first.second);
+    }
+    const int numPoints = points.size();
+
+    //k-means++ seeding: the next center is drawn with probability ~ D(x)^2
+    const quint32 seedBuffer[2] = { seed, 0xffffffffu }; //stream not used by initialize()
+    QRandomGenerator rng(seedBuffer);
+    QVector<double> distances(numPoints);
+    centers[0] = points[rng.bounded(numPoints)];
+    for (int j = 0; j < numPoints; ++j) {
+        distances[j] = (points[j] - centers[0]) * (points[j] - centers[0]);
+    }
+    for (int i = 1; i < numNeurons; ++i) {
+        double total = 0.0;
+        for (int j = 0; j < numPoints; ++j) total += distances[j];
+
+        int chosen = numPoints - 1;
+        if (total > 0.0) {
+            double target = rng.generateDouble() * total;
+            for (int j = 0; j < numPoints; ++j) {
+                target -= distances[j];
+                if (target < 0.0) { chosen = j; break; }
+            }
+        } else {
+            //less distinct points than neurons, duplicates are spread later
+            chosen = rng.bounded(numPoints);
+        }
+        centers[i] = points[chosen];
+
+        for (int j = 0; j < numPoints; ++j) {
+            double d = (points[j] - centers[i]) * (points[j] - centers[i]);
+            if (d < distances[j]) distances[j] = d;
+        }
+    }
+
+    //Lloyd iterations, the assignment step runs on fixed chunks in parallel and
+    //the partial sums are reduced in chunk order so the result is deterministic
+    const int chunkSize = 4096;
+    QVector<KMeansChunk> chunks;
+    for (int begin = 0; begin < numPoints; begin += chunkSize) {
+        chunks.append({ begin, qMin(numPoints, begin + chunkSize), QVector<double>(), QVector<int>(), 0.0 });
+    }
+
+    std::sort(centers.begin(), centers.end());
+    double previousCost = -1.0;
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        const QVector<double> sortedCenters = centers;
+        auto assign = [&sortedCenters, &points](KMeansChunk& chunk) {
+            chunk.sums.fill(0.0, sortedCenters.size());
+            chunk.counts.fill(0, sortedCenters.size());
+            chunk.cost = 0.0;
+            for (int j = chunk.begin; j < chunk.end; ++j) {
+                int c = nearestCenter(sortedCenters, points[j]);
+                chunk.sums[c] += points[j];
+                chunk.counts[c]++;
+                chunk.cost += (points[j] - sortedCenters[c]) * (points[j] - sortedCenters[c]);
+            }
+        };
+        if (chunks.size() == 1) assign(chunks[0]);
+        else QtConcurrent::blockingMap(chunks, assign);
+
+        QVector<double> sums(numNeurons, 0.0);
+        QVector<int> counts(numNeurons, 0);
+        double cost = 0.0;
+        for (const auto& chunk : chunks) {
+            for (int i = 0; i < numNeurons; ++i) {
+                sums[i] += chunk.sums[i];
+                counts[i] += chunk.counts[i];
+            }
+            cost += chunk.cost;
+        }
+
+        //empty clusters keep their center
+        for (int i = 0; i < numNeurons; ++i) {
+            if (counts[i] > 0) centers[i] = sums[i] / counts[i];
+        }
+        std::sort(centers.begin(), centers.end());
+
+        if (cost == previousCost) break;
+        previousCost = cost;
+    }
+
+    //duplicate centers (more neurons than distinct coordinates) are moved
+    //half way to the next center so every neuron covers its own interval
+    for (int i = 1; i < numNeurons; ++i) {
+        if (centers[i] <= centers[i - 1]) {
+            int next = i;
+            while (next < numNeurons && centers[next] <= centers[i - 1]) next++;
+            double upper = (next < numNeurons) ? centers[next] : centers[i - 1] + 1.0;
+            for (int k = i; k < next; ++k) {
+                centers[k] = centers[i - 1] + (upper - centers[i - 1]) * (k - i + 1) / (2.0 * (next - i + 1));
+            }
+        }
+    }
+
+    //stdDevs from the distance to the nearest neighbouring center
+    for (int i = 0; i < numNeurons; ++i) {
+        double nearest = -1.0;
+        if (i > 0) nearest = centers[i] - centers[i - 1];
+        if (i + 1 < numNeurons && (nearest < 0.0 || centers[i + 1] - centers[i] < nearest)) {
+            nearest = centers[i + 1] - centers[i];
+        }
+        if (nearest <= 0.0) nearest = 1.0; //single neuron
+        stdDevs[i] = qMax(0.001, sigmaScale * nearest);
+    }
+}
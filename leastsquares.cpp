@@ -0,0 +1,38 @@
+#include "rrbfnetwork.h"
+#include "linalg.h"
+
+// For fixed centers and stdDevs the output is linear in the weights, so the
+// weights minimizing the training error solve (Phi^T Phi + ridge I) w = Phi^T t
+// where Phi is the samples x neurons matrix of basis function values
+
+bool RRBFNetwork::solveWeights(const TrainingSet& data, double ridge)
+{
+    if (numNeurons == 0 || data.isEmpty()) return false;
+
+    const int n = numNeurons;
+    QVector<double> gram, rhs;
+    buildNormalEquations(data.size(), n, [this, &data, n](int j, double* row, double& target) {
+        const auto& sample = data[j];
+        for (int i = 0; i < n; ++i) {
+            row[i] = computePhi(i, sample.first.first, sample.first.second);
+        }
+        target = sample.second;
+    }, gram, rhs);
+
+    //ridge relative to the mean diagonal, increased until the system is positive definite
+    double trace = 0.0;
+    for (int i = 0; i < n; ++i) trace += gram[i * n + i];
+    double lambda = ridge * qMax(trace / n, 1e-12);
+
+    for (int attempt = 0; attempt < 8; ++attempt, lambda *= 100.0) {
+        QVector<double> factor = gram;
+        for (int i = 0; i < n; ++i) factor[i * n + i] += lambda;
+        if (!choleskyDecompose(factor, n)) continue;
+
+        QVector<double> solution = rhs;
+        choleskySolve(factor, n, solution);
+        weights = solution;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,61 @@
+#include "rrbftrainer.h"
+#include "linalg.h"
+
+// One Levenberg-Marquardt iteration over the whole training set. With J the
+// samples x 3N Jacobian of the output and r = target - output, the step
+// solves (J^T J + mu * diag(J^T J)) delta = J^T r. A step that lowers the
+// error is kept and mu shrinks, otherwise mu grows and the step is retried.
+// false if no retry lowered the error, the parameters are then unchanged.
+
+bool RRBFTrainer::levenbergMarquardtStep(double& error)
+{
+    const int numNeurons = network.numNeurons;
+    const int n = 3 * numNeurons;
+
+    QVector<double> jtj, jtr;
+    buildNormalEquations(trainingData.size(), n, [this](int j, double* row, double& residual) {
+        const auto& sample = trainingData[j];
+        residual = sample.second - network.computeJacobianRow(sample.first.first, sample.first.second, row);
+    }, jtj, jtr);
+
+    if (stepCounter == 0 || totalError == 0.0) totalError = network.computeError(trainingData);
+    const double currentError = totalError;
+
+    const QVector<double> weights = network.weights;
+    const QVector<double> stdDevs = network.stdDevs;
+    const QVector<double> centers = network.centers;
+
+    for (int attempt = 0; attempt < 10; ++attempt) {
+        QVector<double> factor = jtj;
+        for (int i = 0; i < n; ++i) {
+            factor[i * n + i] += lmDamping * qMax(jtj[i * n + i], 1e-12);
+        }
+
+        if (choleskyDecompose(factor, n)) {
+            QVector<double> delta = jtr;
+            choleskySolve(factor, n, delta);
+
+            for (int i = 0; i < numNeurons; ++i) {
+                network.weights[i] = weights[i] + delta[i];
+                network.stdDevs[i] = qMax(0.001, stdDevs[i] + delta[numNeurons + i]);
+                network.centers[i] = centers[i] + delta[2 * numNeurons + i];
+            }
+
+            double newError = network.computeError(trainingData);
+            if (newError < currentError) {
+                lmDamping = qMax(lmDamping / 10.0, 1e-12);
+                error = newError;
+                return true;
+            }
+        }
+
+        //rejected, go back towards gradient descent
+        lmDamping = qMin(lmDamping * 10.0, 1e12);
+    }
+
+    network.weights = weights;
+    network.stdDevs = stdDevs;
+    network.centers = centers;
+    error = currentError;
+    return false;
+}
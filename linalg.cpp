@@ -0,0 +1,136 @@
+#include "linalg.h"
+
+#include <QtMath>
+#include <QtConcurrent>
+
+// tile size for the Gram accumulation, a 64 x 64 tile of doubles (32 KB)
+// stays in L1/L2 while all rows of a block stream over it
+static const int gramTile = 64;
+
+void addGram(const double* rows, int m, int n, double* a)
+{
+    for (int ii = 0; ii < n; ii += gramTile) {
+        int iEnd = qMin(n, ii + gramTile);
+        for (int jj = ii; jj < n; jj += gramTile) {
+            int jEnd = qMin(n, jj + gramTile);
+            for (int r = 0; r < m; ++r) {
+                const double* row = rows + static_cast<qsizetype>(r) * n;
+                for (int i = ii; i < iEnd; ++i) {
+                    double ri = row[i];
+                    if (ri == 0.0) continue;
+                    double* ai = a + static_cast<qsizetype>(i) * n;
+                    for (int j = qMax(i, jj); j < jEnd; ++j) {
+                        ai[j] += ri * row[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void addTransposedProduct(const double* rows, int m, int n, const double* v, double* out)
+{
+    for (int r = 0; r < m; ++r) {
+        const double* row = rows + static_cast<qsizetype>(r) * n;
+        double vr = v[r];
+        for (int i = 0; i < n; ++i) {
+            out[i] += row[i] * vr;
+        }
+    }
+}
+
+void mirrorUpper(double* a, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            a[static_cast<qsizetype>(j) * n + i] = a[static_cast<qsizetype>(i) * n + j];
+        }
+    }
+}
+
+bool choleskyDecompose(QVector<double>& a, int n)
+{
+    for (int j = 0; j < n; ++j) {
+        double* aj = a.data() + static_cast<qsizetype>(j) * n;
+        double diagonal = aj[j];
+        for (int k = 0; k < j; ++k) diagonal -= aj[k] * aj[k];
+        if (diagonal <= 0.0 || !qIsFinite(diagonal)) return false;
+        diagonal = qSqrt(diagonal);
+        aj[j] = diagonal;
+
+        for (int i = j + 1; i < n; ++i) {
+            double* ai = a.data() + static_cast<qsizetype>(i) * n;
+            double sum = ai[j];
+            for (int k = 0; k < j; ++k) sum -= ai[k] * aj[k];
+            ai[j] = sum / diagonal;
+        }
+    }
+    return true;
+}
+
+void choleskySolve(const QVector<double>& l, int n, QVector<double>& b)
+{
+    //forward substitution L y = b
+    for (int i = 0; i < n; ++i) {
+        const double* li = l.constData() + static_cast<qsizetype>(i) * n;
+        double sum = b[i];
+        for (int k = 0; k < i; ++k) sum -= li[k] * b[k];
+        b[i] = sum / li[i];
+    }
+    //back substitution L^T x = y
+    for (int i = n - 1; i >= 0; --i) {
+        double sum = b[i];
+        for (int k = i + 1; k < n; ++k) sum -= l[static_cast<qsizetype>(k) * n + i] * b[k];
+        b[i] = sum / l[static_cast<qsizetype>(i) * n + i];
+    }
+}
+
+namespace {
+
+struct NormalEquationChunk
+{
+    int begin;
+    int end;
+    QVector<double> gram;   // n x n, upper triangle
+    QVector<double> rhs;
+};
+
+}
+
+void buildNormalEquations(int numRows, int n, const std::function<void(int, double*, double&)>& fillRow, QVector<double>& gram, QVector<double>& rhs)
+{
+    const int rowBlock = 256;
+    const int maxChunks = 16;
+    int numChunks = qMax(1, qMin(maxChunks, (numRows + rowBlock - 1) / rowBlock));
+    int chunkSize = qMax(1, (numRows + numChunks - 1) / numChunks);
+
+    QVector<NormalEquationChunk> chunks;
+    for (int begin = 0; begin < numRows; begin += chunkSize) {
+        chunks.append({ begin, qMin(numRows, begin + chunkSize), QVector<double>(), QVector<double>() });
+    }
+
+    auto accumulate = [&fillRow, n, rowBlock](NormalEquationChunk& chunk) {
+        chunk.gram.fill(0.0, n * n);
+        chunk.rhs.fill(0.0, n);
+        QVector<double> rows(rowBlock * n);
+        QVector<double> targets(rowBlock);
+        for (int begin = chunk.begin; begin < chunk.end; begin += rowBlock) {
+            int count = qMin(rowBlock, chunk.end - begin);
+            for (int r = 0; r < count; ++r) {
+                fillRow(begin + r, rows.data() + r * n, targets[r]);
+            }
+            addGram(rows.constData(), count, n, chunk.gram.data());
+            addTransposedProduct(rows.constData(), count, n, targets.constData(), chunk.rhs.data());
+        }
+    };
+    if (chunks.size() == 1) accumulate(chunks[0]);
+    else QtConcurrent::blockingMap(chunks, accumulate);
+
+    gram.fill(0.0, n * n);
+    rhs.fill(0.0, n);
+    for (const auto& chunk : chunks) {
+        for (int k = 0; k < n * n; ++k) gram[k] += chunk.gram[k];
+        for (int i = 0; i < n; ++i) rhs[i] += chunk.rhs[i];
+    }
+    mirrorUpper(gram.data(), n);
+}
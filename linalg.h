@@ -0,0 +1,31 @@
+#ifndef LINALG_H
+#define LINALG_H
+
+#include <QVector>
+#include <functional>
+
+// small dense linear algebra helpers for the least squares and
+// Levenberg-Marquardt solvers, matrices are n x n row-major
+
+// a += rows^T * rows for an m x n row-major block of rows, only the upper
+// triangle of a is updated (call mirrorUpper() when all blocks are added)
+void addGram(const double* rows, int m, int n, double* a);
+// out += rows^T * v
+void addTransposedProduct(const double* rows, int m, int n, const double* v, double* out);
+void mirrorUpper(double* a, int n);
+
+// builds gram = A^T A (full matrix) and rhs = A^T t for a numRows x n matrix A
+// whose rows are produced by fillRow(rowIndex, row, target). Rows are
+// processed in a fixed number of ranges in parallel and reduced in order,
+// so the result does not depend on the thread count.
+void buildNormalEquations(int numRows, int n,
+                          const std::function<void(int, double*, double&)>& fillRow,
+                          QVector<double>& gram, QVector<double>& rhs);
+
+// in-place Cholesky factorization a = L L^T, returns false if a is not
+// positive definite. The lower triangle of a holds L afterwards.
+bool choleskyDecompose(QVector<double>& a, int n);
+// solves L L^T x = b in place
+void choleskySolve(const QVector<double>& l, int n, QVector<double>& b);
+
+#endif // LINALG_H
@@ -0,0 +1,176 @@
+#include "loadgen.h"
+#include "batcher.h"
+#include "commandline.h"
+#include "rrbfnetwork.h"
+
+#include <QFile>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+struct LoadResult
+{
+    QString maxBatch;       // "direct" for the unbatched baseline
+    int maxWaitUs;
+    int clients;
+    double requestsPerSecond;
+    double meanBatch;
+    double p50Us, p99Us;
+};
+
+// runs clients threads for durationMs, each sending one request at a time
+template <typename Predict>
+LoadResult runClients(int clients, int durationMs, Predict predict)
+{
+    std::vector<std::vector<qint64>> latencies(clients);
+    std::atomic<bool> running(true);
+    std::vector<std::thread> threads;
+
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c]() {
+            const quint32 seedBuffer[2] = { 0x10adu, static_cast<quint32>(c) };
+            QRandomGenerator rng(seedBuffer);
+            std::vector<qint64>& own = latencies[c];
+            own.reserve(1 << 16);
+            while (running.load(std::memory_order_relaxed)) {
+                double x = rng.generateDouble() * 6.0 - 3.0;
+                double y = rng.generateDouble() * 6.0 - 3.0;
+                auto start = std::chrono::steady_clock::now();
+                volatile double z = predict(x, y);
+                (void)z;
+                own.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - start).count());
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+    running = false;
+    for (std::thread& thread : threads) thread.join();
+
+    std::vector<qint64> all;
+    for (const auto& own : latencies) all.insert(all.end(), own.begin(), own.end());
+    LoadResult result;
+    result.clients = clients;
+    result.requestsPerSecond = all.size() * 1000.0 / durationMs;
+    result.p50Us = result.p99Us = 0.0;
+    if (!all.empty()) {
+        std::sort(all.begin(), all.end());
+        result.p50Us = all[all.size() / 2] / 1000.0;
+        result.p99Us = all[static_cast<std::size_t>(0.99 * (all.size() - 1))] / 1000.0;
+    }
+    return result;
+}
+
+}
+
+void addLoadGeneratorOptions(QCommandLineParser& parser)
+{
+    parser.addOptions({
+        {"loadgen", "Measure the micro-batching front end under local load (list options take comma separated values)."},
+        {"model", "Model file for --loadgen (default: a random network of --neurons and --seed).", "file"},
+        {"clients", "Concurrent client threads (default 1,4,16).", "n"},
+        {"max-batch", "Largest batch of the front end (default 1,8,32,128).", "n"},
+        {"max-wait-us", "Longest wait for a batch to fill up in microseconds (default 0,50,200).", "us"},
+        {"duration", "Seconds per combination (default 1).", "seconds"},
+        {"swap-every", "Publish a new copy of the model every n ms while measuring (default 0 = never).", "ms"},
+    });
+}
+
+int runLoadGenerator(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+
+    RRBFNetwork network;
+    if (parser.isSet("model")) {
+        if (!network.load(parser.value("model"))) return 1;
+    } else {
+        int neurons = parser.isSet("neurons") ? parser.value("neurons").toInt() : 16;
+        quint32 seed = parser.isSet("seed") ? parser.value("seed").toUInt() : 1;
+        network.initialize(qMax(1, neurons), seed);
+    }
+    //--cull-tolerance is a server option, the load generator uses it as well
+    double cullTolerance = parser.isSet("cull-tolerance") ? parser.value("cull-tolerance").toDouble() : 0.0;
+    auto makeModel = [&network, cullTolerance]() {
+        std::unique_ptr<RRBFPredictor> model(new RRBFPredictor(network));
+        model->enableCulling(cullTolerance);
+        return std::unique_ptr<const RRBFPredictor>(std::move(model));
+    };
+    ModelStore store(makeModel());
+
+    //republish a copy of the model in the background to show that swaps do not stall inference
+    int swapEveryMs = parser.isSet("swap-every") ? parser.value("swap-every").toInt() : 0;
+    std::atomic<bool> swapping(swapEveryMs > 0);
+    std::thread swapper([&]() {
+        while (swapping.load()) {
+            store.publish(makeModel());
+            std::this_thread::sleep_for(std::chrono::milliseconds(swapEveryMs));
+        }
+    });
+
+    QStringList clients = listValue(parser, "clients", "1,4,16");
+    QStringList maxBatches = listValue(parser, "max-batch", "1,8,32,128");
+    QStringList maxWaits = listValue(parser, "max-wait-us", "0,50,200");
+    int durationMs = qMax(1, int(1000 * (parser.isSet("duration") ? parser.value("duration").toDouble() : 1.0)));
+
+    out << QString("%1 neurons, %2 ms per combination").arg(network.numNeurons).arg(durationMs) << Qt::endl;
+
+    QVector<LoadResult> results;
+    for (const QString& c : clients) {
+        //baseline: every client calls the predictor itself
+        LoadResult direct = runClients(c.toInt(), durationMs, [&store](double x, double y) {
+            ModelStore::ReadGuard model(store);
+            return model->predict(x, y);
+        });
+        direct.maxBatch = "direct";
+        direct.maxWaitUs = 0;
+        direct.meanBatch = 1.0;
+        results.append(direct);
+
+        for (const QString& batch : maxBatches) {
+            for (const QString& wait : maxWaits) {
+                MicroBatcher batcher(store, batch.toInt(), std::chrono::microseconds(wait.toInt()));
+                LoadResult result = runClients(c.toInt(), durationMs, [&batcher](double x, double y) {
+                    return batcher.predict(x, y);
+                });
+                result.maxBatch = batch;
+                result.maxWaitUs = wait.toInt();
+                result.meanBatch = batcher.batchCount() > 0 ? double(batcher.requestCount()) / batcher.batchCount() : 0.0;
+                results.append(result);
+            }
+        }
+    }
+
+    swapping = false;
+    swapper.join();
+    if (swapEveryMs > 0) out << QString("%1 model swaps during the run").arg(store.version()) << Qt::endl;
+
+    QStringList header = { "clients", "max_batch", "max_wait_us", "requests/s", "mean_batch", "p50_us", "p99_us" };
+    auto row = [](const LoadResult& r) {
+        return QStringList{ QString::number(r.clients), r.maxBatch, QString::number(r.maxWaitUs),
+                            QString::number(r.requestsPerSecond, 'f', 0), QString::number(r.meanBatch, 'f', 1),
+                            QString::number(r.p50Us, 'f', 1), QString::number(r.p99Us, 'f', 1) };
+    };
+
+    for (const QString& column : header) out << column.leftJustified(14);
+    out << Qt::endl;
+    for (const LoadResult& r : results) {
+        for (const QString& value : row(r)) out << value.leftJustified(14);
+        out << Qt::endl;
+    }
+
+    if (parser.isSet("csv")) {
+        QFile file(parser.value("csv"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            out << "error: cannot write " << parser.value("csv") << Qt::endl;
+            return 1;
+        }
+        QTextStream csv(&file);
+        csv << header.join(',') << '\n';
+        for (const LoadResult& r : results) csv << row(r).join(',') << '\n';
+    }
+    return 0;
+}
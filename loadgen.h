@@ -0,0 +1,13 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <QCommandLineParser>
+
+// local load generator for MicroBatcher: closed loop client threads send
+// single-point predictions for every combination of the comma separated
+// --clients, --max-batch and --max-wait-us values and the throughput and
+// latency of each combination are printed as a table
+void addLoadGeneratorOptions(QCommandLineParser& parser);
+int runLoadGenerator(const QCommandLineParser& parser);
+
+#endif // LOADGEN_H
@@ -1,11 +1,27 @@
 #include "mainwindow.h"
+#include "commandline.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    if (isHeadlessMode(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        QCommandLineParser parser;
+        addCommandLineOptions(parser);
+        parser.process(a);
+        if (!checkOptions(parser)) return 1;
+        return runHeadless(parser);
+    }
+
     QApplication a(argc, argv);
+    QCommandLineParser parser;
+    addCommandLineOptions(parser);
+    parser.process(a);
+    if (!checkOptions(parser)) return 1;
+
     MainWindow w;
+    w.applyTrainingOptions(trainingOptionsFromParser(parser, w.trainingOptions()));
     w.show();
     return a.exec();
 }
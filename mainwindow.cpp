@@ -4,6 +4,7 @@
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , trainer(network, trainingData)
 {
     ui->setupUi(this);
 
@@ -14,10 +15,10 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->createTrainingSetButton, SIGNAL(clicked(bool)), this, SLOT(createTrainingDataSet()));
     connect(ui->pushButton_find_Z, SIGNAL(clicked(bool)), this, SLOT(FindZ()));
     connect(ui->drawTestGraphButton, SIGNAL(clicked(bool)), this, SLOT(drawTestGraph())); // Yeni bağlantı
+    connect(ui->saveModelButton, SIGNAL(clicked(bool)), this, SLOT(saveModel()));
+    connect(ui->loadModelButton, SIGNAL(clicked(bool)), this, SLOT(loadModel()));
 
     training = false;
-    epochCounter = 0;
-    stepCounter = 0;
     errorHistory.clear();
     stepIndices.clear();
 
@@ -60,3 +61,63 @@ MainWindow::~MainWindow()
 
 }
 
+void MainWindow::applyTrainingOptions(const TrainingOptions& options)
+{
+    commandLineOptions = options;
+    ui->neuronSpinBox->setValue(options.numNeurons);
+    ui->learningRateSpinBox->setValue(options.learningRate);
+    ui->stopConditionSpinBox->setValue(options.stopCondition);
+    ui->seedSpinBox->setValue(static_cast<int>(options.seed));
+    ui->initComboBox->setCurrentIndex(options.initMethod);
+    ui->leastSquaresCheckBox->setChecked(options.solveWeights);
+    ui->leastSquaresIntervalSpinBox->setValue(options.solveWeightsInterval);
+    ui->optimizerComboBox->setCurrentIndex(options.optimizer);
+    ui->momentumSpinBox->setValue(options.momentum);
+    ui->levenbergMarquardtCheckBox->setChecked(options.levenbergMarquardt);
+    ui->batchSizeSpinBox->setValue(options.batchSize);
+    ui->validationSplitSpinBox->setValue(options.validationFraction);
+    ui->validationIntervalSpinBox->setValue(options.validationInterval);
+    ui->patienceSpinBox->setValue(options.patience);
+    ui->minDeltaSpinBox->setValue(options.minDelta);
+    ui->restoreBestCheckBox->setChecked(options.restoreBest);
+    ui->scheduleComboBox->setCurrentIndex(options.schedule);
+    ui->schedulePeriodSpinBox->setValue(options.schedulePeriod);
+    ui->scheduleGammaSpinBox->setValue(options.scheduleGamma);
+    ui->minLearningRateSpinBox->setValue(options.minLearningRate);
+    ui->restartMultiplierSpinBox->setValue(options.restartMultiplier);
+    ui->weightsRateScaleSpinBox->setValue(options.weightsRateScale);
+    ui->stdDevsRateScaleSpinBox->setValue(options.stdDevsRateScale);
+    ui->centersRateScaleSpinBox->setValue(options.centersRateScale);
+}
+
+TrainingOptions MainWindow::trainingOptions() const
+{
+    //the widgets override the options they show
+    TrainingOptions options = commandLineOptions;
+    options.numNeurons = ui->neuronSpinBox->value();
+    options.learningRate = ui->learningRateSpinBox->value();
+    options.stopCondition = ui->stopConditionSpinBox->value();
+    options.seed = static_cast<quint32>(ui->seedSpinBox->value());
+    options.initMethod = static_cast<TrainingOptions::InitMethod>(ui->initComboBox->currentIndex());
+    options.solveWeights = ui->leastSquaresCheckBox->isChecked();
+    options.solveWeightsInterval = ui->leastSquaresIntervalSpinBox->value();
+    options.optimizer = static_cast<RRBFOptimizer::Type>(ui->optimizerComboBox->currentIndex());
+    options.momentum = ui->momentumSpinBox->value();
+    options.levenbergMarquardt = ui->levenbergMarquardtCheckBox->isChecked();
+    options.batchSize = ui->batchSizeSpinBox->value();
+    options.validationFraction = ui->validationSplitSpinBox->value();
+    options.validationInterval = ui->validationIntervalSpinBox->value();
+    options.patience = ui->patienceSpinBox->value();
+    options.minDelta = ui->minDeltaSpinBox->value();
+    options.restoreBest = ui->restoreBestCheckBox->isChecked();
+    options.schedule = static_cast<LearningRateSchedule::Type>(ui->scheduleComboBox->currentIndex());
+    options.schedulePeriod = ui->schedulePeriodSpinBox->value();
+    options.scheduleGamma = ui->scheduleGammaSpinBox->value();
+    options.minLearningRate = ui->minLearningRateSpinBox->value();
+    options.restartMultiplier = ui->restartMultiplierSpinBox->value();
+    options.weightsRateScale = ui->weightsRateScaleSpinBox->value();
+    options.stdDevsRateScale = ui->stdDevsRateScaleSpinBox->value();
+    options.centersRateScale = ui->centersRateScaleSpinBox->value();
+    return options;
+}
+
@@ -10,7 +10,11 @@
 #include <QString>
 #include <QtMath>
 #include <QRandomGenerator>
+#include <QFileDialog>
 #include "qcustomplot.h"
+#include "rrbfnetwork.h"
+#include "rrbftrainer.h"
+#include "profiler.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -24,23 +28,24 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    void applyTrainingOptions(const TrainingOptions& options);
+    TrainingOptions trainingOptions() const;
+
 private:
     Ui::MainWindow *ui;
+    // the options without a widget (basis, sparse threshold, growing,
+    // prioritized sampling, initial stdDev range, ...) as last applied
+    TrainingOptions commandLineOptions;
 
     // RRBF ağ parametreleri
-    QVector<double> centers; // m_i
-    QVector<double> stdDevs; // delta_i
-    QVector<double> weights; // w_i
-    int numNeurons;
+    RRBFNetwork network;
     bool training;
-    size_t dataIndex; // Eğitim döngüsünde hangi veri noktasının işlendiğini takip eder
-    int epochCounter;       // Yeni epoch sayacı
     QCustomPlot* customPlot;
     QVector<double> errorHistory; // Hata değerlerini saklamak için
     QVector<double> stepIndices;  // Adım indekslerini saklamak için
-    int stepCounter;              // Adım sayacı
     // Eğitim verisi
-    QVector<QPair<QPair<double, double>, double>> trainingData;
+    TrainingSet trainingData;
+    RRBFTrainer trainer;
 
     // Test grafiği için yeni değişkenler
     QCustomPlot* testPlot; // Yeni bir QCustomPlot widget'ı
@@ -48,18 +53,6 @@ private:
     QVector<double> networkOutputs; // Ağın çıkışları
     QVector<double> targetOutputs; // Hedef çıkışlar
 
-    // RRBF işlevleri
-    void initializeNetwork(int numNeurons_);
-    double computePhi(int i, double x, double y) const;
-    double computeOutput(double x, double y) const;
-    void computeGradients(double x, double y, double y_desired,
-                      QVector<double>& grad_weights,
-                      QVector<double>& grad_stdDevs,
-                      QVector<double>& grad_centers) const;
-    void updateParameters(const QVector<double>& grad_weights,
-                       const QVector<double>& grad_stdDevs,
-                       const QVector<double>& grad_centers,
-                       double learningRate);
 
 private slots:
     void createTrainingDataSet();
@@ -67,8 +60,11 @@ private slots:
     void stopTraining();
     void trainStep();
     void drawGraph();
+    void updateDiagnostics();
     void FindZ();
     void drawTestGraph(); // Yeni slot
+    void saveModel();
+    void loadModel();
 
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,184 @@
+#include "metrics.h"
+#include "profiler.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSaveFile>
+#include <QStringList>
+
+namespace {
+
+void addMetric(QStringList& lines, const QString& name, const QString& type, const QString& help)
+{
+    lines << QString("# HELP %1 %2").arg(name, help);
+    lines << QString("# TYPE %1 %2").arg(name, type);
+}
+
+QString value(double v)
+{
+    return QString::number(v, 'g', 10);
+}
+
+double norm(const QVector<double>& values)
+{
+    double sum = 0.0;
+    for (double v : values) sum += v * v;
+    return qSqrt(sum);
+}
+
+}
+
+MetricsExporter::MetricsExporter()
+{
+    intervalMs = 1000;
+    server = nullptr;
+    lastStep = 0;
+    stepsPerSecond = 0.0;
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    delete server;
+}
+
+void MetricsExporter::setFile(const QString& fileName_)
+{
+    fileName = fileName_;
+}
+
+bool MetricsExporter::listen(const QString& socketName)
+{
+    delete server;
+    server = new QLocalServer();
+    QLocalServer::removeServer(socketName); //stale socket of a crashed run
+    if (!server->listen(socketName)) {
+        error = server->errorString();
+        delete server;
+        server = nullptr;
+        return false;
+    }
+    return true;
+}
+
+QString MetricsExporter::errorString() const
+{
+    return error;
+}
+
+bool MetricsExporter::isActive() const
+{
+    return !fileName.isEmpty() || server;
+}
+
+void MetricsExporter::maybePublish(const RRBFTrainer& trainer, const RRBFNetwork& network)
+{
+    if (!isActive()) return;
+    if (timer.isValid() && timer.elapsed() < intervalMs) return;
+    publish(trainer, network);
+}
+
+void MetricsExporter::publish(const RRBFTrainer& trainer, const RRBFNetwork& network)
+{
+    if (!isActive()) return;
+
+    //rate over the last interval, restart when a new run began
+    if (!timer.isValid() || trainer.stepCounter < lastStep) {
+        lastStep = 0;
+        stepsPerSecond = 0.0;
+        timer.start();
+    } else if (timer.elapsed() > 0) {
+        stepsPerSecond = (trainer.stepCounter - lastStep) * 1000.0 / timer.elapsed();
+        lastStep = trainer.stepCounter;
+        timer.restart();
+    }
+
+    QByteArray text = render(trainer, network).toUtf8();
+
+    if (!fileName.isEmpty()) {
+        QSaveFile file(fileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(text);
+            file.commit();
+        }
+    }
+
+    if (server) {
+        while (server->waitForNewConnection(0) && server->hasPendingConnections()) {
+            QLocalSocket* socket = server->nextPendingConnection();
+            socket->write(text);
+            socket->waitForBytesWritten(100);
+            socket->disconnectFromServer();
+            delete socket;
+        }
+    }
+}
+
+QString MetricsExporter::render(const RRBFTrainer& trainer, const RRBFNetwork& network)
+{
+    QStringList lines;
+
+    addMetric(lines, "rrbf_steps_total", "counter", "Training steps since the run started.");
+    lines << QString("rrbf_steps_total %1").arg(trainer.stepCounter);
+    addMetric(lines, "rrbf_samples_total", "counter", "Samples processed by the gradient steps.");
+    lines << QString("rrbf_samples_total %1").arg(trainer.stepCounter * trainer.samplesPerStep());
+    addMetric(lines, "rrbf_epoch", "gauge", "Passes over the training set.");
+    lines << QString("rrbf_epoch %1").arg(trainer.epochCounter);
+    addMetric(lines, "rrbf_steps_per_second", "gauge", "Training steps per second over the last interval.");
+    lines << "rrbf_steps_per_second " + value(stepsPerSecond);
+    addMetric(lines, "rrbf_samples_per_second", "gauge", "Samples per second over the last interval.");
+    lines << "rrbf_samples_per_second " + value(stepsPerSecond * trainer.samplesPerStep());
+    addMetric(lines, "rrbf_elapsed_seconds", "gauge", "Wall time since the run started.");
+    lines << "rrbf_elapsed_seconds " + value(trainer.elapsedMs() / 1000.0);
+
+    addMetric(lines, "rrbf_error", "gauge", "Training error after the last step, mean of 0.5*e^2.");
+    lines << "rrbf_error " + value(trainer.totalError);
+    addMetric(lines, "rrbf_best_error", "gauge", "Lowest training error of the run.");
+    lines << "rrbf_best_error " + value(trainer.stepCounter > 0 ? trainer.bestError : trainer.totalError);
+    if (!trainer.validationData.isEmpty()) {
+        addMetric(lines, "rrbf_validation_error", "gauge", "Error on the held-out samples at the last evaluation.");
+        lines << "rrbf_validation_error " + value(trainer.validationError);
+        addMetric(lines, "rrbf_best_validation_error", "gauge", "Lowest validation error of the run.");
+        lines << "rrbf_best_validation_error " + value(trainer.bestValidationStep > 0 ? trainer.bestValidationError : 0.0);
+        addMetric(lines, "rrbf_early_stopped", "gauge", "1 once the patience ran out.");
+        lines << QString("rrbf_early_stopped %1").arg(trainer.earlyStopped ? 1 : 0);
+    }
+    addMetric(lines, "rrbf_learning_rate", "gauge", "Learning rate of the last step after the schedule.");
+    lines << "rrbf_learning_rate " + value(trainer.learningRate());
+    addMetric(lines, "rrbf_stop_condition", "gauge", "Error at which the run stops.");
+    lines << "rrbf_stop_condition " + value(trainer.options.stopCondition);
+    addMetric(lines, "rrbf_neurons", "gauge", "Neurons in the network.");
+    lines << QString("rrbf_neurons %1").arg(network.numNeurons);
+    if (trainer.usesSparseGradients()) {
+        addMetric(lines, "rrbf_active_fraction", "gauge", "Share of the neurons a sparse step trained, last epoch.");
+        lines << "rrbf_active_fraction " + value(trainer.activeFraction);
+    }
+
+    addMetric(lines, "rrbf_parameter_norm", "gauge", "L2 norm of each parameter group.");
+    lines << "rrbf_parameter_norm{group=\"weights\"} " + value(norm(network.weights));
+    lines << "rrbf_parameter_norm{group=\"stddevs\"} " + value(norm(network.stdDevs));
+    lines << "rrbf_parameter_norm{group=\"centers\"} " + value(norm(network.centers));
+
+    double gradWeights, gradStdDevs, gradCenters;
+    trainer.gradientNorms(gradWeights, gradStdDevs, gradCenters);
+    addMetric(lines, "rrbf_gradient_norm", "gauge", "L2 norm of the last applied gradient per parameter group.");
+    lines << "rrbf_gradient_norm{group=\"weights\"} " + value(gradWeights);
+    lines << "rrbf_gradient_norm{group=\"stddevs\"} " + value(gradStdDevs);
+    lines << "rrbf_gradient_norm{group=\"centers\"} " + value(gradCenters);
+
+    if (Profiler::isEnabled()) {
+        qint64 counts[PhaseCount], totalNs[PhaseCount];
+        Profiler::totals(counts, totalNs);
+        addMetric(lines, "rrbf_phase_seconds_total", "counter", "Time spent per training loop phase.");
+        for (int p = 0; p < PhaseCount; ++p) {
+            lines << QString("rrbf_phase_seconds_total{phase=\"%1\"} %2")
+                     .arg(Profiler::phaseName(ProfilePhase(p)), value(totalNs[p] * 1e-9));
+        }
+        addMetric(lines, "rrbf_phase_calls_total", "counter", "Calls per training loop phase.");
+        for (int p = 0; p < PhaseCount; ++p) {
+            lines << QString("rrbf_phase_calls_total{phase=\"%1\"} %2")
+                     .arg(Profiler::phaseName(ProfilePhase(p))).arg(counts[p]);
+        }
+    }
+
+    return lines.join('\n') + "\n";
+}
@@ -0,0 +1,49 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "rrbftrainer.h"
+
+#include <QString>
+#include <QElapsedTimer>
+
+class QLocalServer;
+
+// Training metrics in the Prometheus text format: throughput, current and
+// best error, epoch, parameter and gradient norms and the profiler's time
+// per phase. publish() rewrites the text file atomically (for the
+// node_exporter textfile collector) and/or answers every client waiting on
+// the Unix socket with the latest snapshot. There is no event loop involved,
+// so clients are served at the next publish().
+class MetricsExporter
+{
+public:
+    MetricsExporter();
+    ~MetricsExporter();
+
+    void setFile(const QString& fileName);
+    bool listen(const QString& socketName);
+    QString errorString() const;
+
+    bool isActive() const;
+    int intervalMs;         // minimum time between two publish() calls by maybePublish()
+
+    // call after every trainStep(), publishes when intervalMs has passed
+    void maybePublish(const RRBFTrainer& trainer, const RRBFNetwork& network);
+    void publish(const RRBFTrainer& trainer, const RRBFNetwork& network);
+
+    QString render(const RRBFTrainer& trainer, const RRBFNetwork& network);
+
+private:
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    QString fileName;
+    QLocalServer* server;
+    QString error;
+
+    QElapsedTimer timer;    // since the last rate sample
+    qint64 lastStep;
+    double stepsPerSecond;
+};
+
+#endif // METRICS_H
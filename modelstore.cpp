@@ -0,0 +1,79 @@
+#include "modelstore.h"
+
+#include <thread>
+
+namespace {
+
+int threadStripe()
+{
+    static std::atomic<unsigned> nextStripe(0);
+    thread_local unsigned stripe = nextStripe.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<int>(stripe);
+}
+
+}
+
+ModelStore::ModelStore()
+    : ModelStore(std::unique_ptr<const RRBFPredictor>())
+{
+}
+
+ModelStore::ModelStore(std::unique_ptr<const RRBFPredictor> model)
+    : current(model.release())
+    , generation(0)
+    , versionCounter(0)
+{
+    for (Stripe& stripe : readers) {
+        stripe.active[0] = 0;
+        stripe.active[1] = 0;
+    }
+}
+
+ModelStore::~ModelStore()
+{
+    delete current.load();
+}
+
+void ModelStore::publish(std::unique_ptr<const RRBFPredictor> model)
+{
+    std::lock_guard<std::mutex> lock(writer);
+    const RRBFPredictor* old = current.exchange(model.release());
+    versionCounter++;
+
+    //grace period: flip twice and drain the parity readers were using each
+    //time, a reader that loaded the generation just before a flip is still
+    //caught by the second one
+    for (int phase = 0; phase < 2; ++phase) {
+        unsigned previous = generation.fetch_add(1);
+        waitForReaders(previous & 1);
+    }
+    delete old;
+}
+
+unsigned long long ModelStore::version() const
+{
+    return versionCounter.load();
+}
+
+void ModelStore::waitForReaders(unsigned parity) const
+{
+    while (true) {
+        long active = 0;
+        for (const Stripe& stripe : readers) active += stripe.active[parity].load();
+        if (active == 0) return;
+        std::this_thread::yield();
+    }
+}
+
+ModelStore::ReadGuard::ReadGuard(const ModelStore& store)
+{
+    Stripe& stripe = store.readers[threadStripe() % stripes];
+    counter = &stripe.active[store.generation.load() & 1];
+    counter->fetch_add(1);
+    model = store.current.load();
+}
+
+ModelStore::ReadGuard::~ReadGuard()
+{
+    counter->fetch_sub(1, std::memory_order_release);
+}
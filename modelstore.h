@@ -0,0 +1,67 @@
+#ifndef MODELSTORE_H
+#define MODELSTORE_H
+
+#include "predictor.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Holds the model that inference runs on and swaps it atomically while
+// predictions are in flight (read-copy-update).
+//
+// Readers take a ReadGuard: one atomic increment of a per-thread-stripe
+// counter and one pointer load, no locks. publish() swaps the pointer,
+// then waits for a grace period (both reader counter parities drained
+// once) before it deletes the old model, so evaluations that started on
+// the old model finish on it and new ones see the new model. Only
+// publish() takes a mutex, to serialize writers.
+class ModelStore
+{
+public:
+    ModelStore();
+    explicit ModelStore(std::unique_ptr<const RRBFPredictor> model);
+    ~ModelStore();
+
+    // blocks until no reader can still see the replaced model
+    void publish(std::unique_ptr<const RRBFPredictor> model);
+    unsigned long long version() const; // number of publish() calls
+
+    // ModelStore::ReadGuard model(store); model->predict(...);
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(const ModelStore& store);
+        ~ReadGuard();
+        const RRBFPredictor* get() const { return model; }
+        const RRBFPredictor* operator->() const { return model; }
+        explicit operator bool() const { return model != nullptr; }
+
+    private:
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        std::atomic<long>* counter;
+        const RRBFPredictor* model;
+    };
+
+private:
+    ModelStore(const ModelStore&) = delete;
+    ModelStore& operator=(const ModelStore&) = delete;
+
+    void waitForReaders(unsigned parity) const;
+
+    static const int stripes = 16;
+    struct alignas(64) Stripe
+    {
+        std::atomic<long> active[2];
+    };
+
+    std::atomic<const RRBFPredictor*> current;
+    std::atomic<unsigned> generation;   // low bit picks the counter new readers use
+    std::atomic<unsigned long long> versionCounter;
+    mutable Stripe readers[stripes];
+    std::mutex writer;
+};
+
+#endif // MODELSTORE_H
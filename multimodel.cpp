@@ -0,0 +1,214 @@
+#include "multimodel.h"
+
+#include <algorithm>
+
+MultiModelTrainer::MultiModelTrainer(const TrainingSet& data_)
+    : data(data_)
+{
+    evaluationInterval = 0;
+    dataIndex = 0;
+    stepCounter = 0;
+    models = 0;
+    maxNeurons = 0;
+}
+
+void MultiModelTrainer::start(const QVector<TrainingOptions>& options_)
+{
+    options = options_;
+    models = options.size();
+    maxNeurons = 0;
+    for (TrainingOptions& modelOptions : options) {
+        if (modelOptions.seed == 0) modelOptions.seed = RRBFNetwork::randomSeed();
+        maxNeurons = qMax(maxNeurons, modelOptions.numNeurons);
+    }
+
+    //padding neurons: zero weight, masked gradient, harmless stdDev
+    const std::size_t size = static_cast<std::size_t>(maxNeurons) * models;
+    weights.assign(size, 0.0);
+    stdDevs.assign(size, 1.0);
+    centers.assign(size, 0.0);
+    mask.assign(size, 0.0);
+    phiX.assign(size, 0.0);
+    phiY.assign(size, 0.0);
+    outputs.assign(models, 0.0);
+    errorFactors.assign(models, 0.0);
+    weightRates.assign(models, 0.0);
+    stdDevRates.assign(models, 0.0);
+    centerRates.assign(models, 0.0);
+
+    for (int m = 0; m < models; ++m) {
+        const TrainingOptions& modelOptions = options[m];
+        RRBFNetwork network;
+        if (modelOptions.initMethod == TrainingOptions::InitKMeans) {
+            network.initializeKMeans(modelOptions.numNeurons, modelOptions.seed, data);
+        } else {
+            network.initialize(modelOptions.numNeurons, modelOptions.seed, modelOptions.initStdDevMin,
+                               modelOptions.initStdDevMax);
+        }
+        if (modelOptions.solveWeights) network.solveWeights(data);
+
+        for (int i = 0; i < network.numNeurons; ++i) {
+            const std::size_t k = static_cast<std::size_t>(i) * models + m;
+            weights[k] = network.weights[i];
+            stdDevs[k] = network.stdDevs[i];
+            centers[k] = network.centers[i];
+            mask[k] = 1.0;
+        }
+        weightRates[m] = modelOptions.learningRate * modelOptions.weightsRateScale;
+        stdDevRates[m] = modelOptions.learningRate * modelOptions.stdDevsRateScale;
+        centerRates[m] = modelOptions.learningRate * modelOptions.centersRateScale;
+    }
+
+    errors.fill(0.0, models);
+    steps.fill(0, models);
+    finishedMs.fill(-1, models);
+    dataIndex = 0;
+    stepCounter = 0;
+    timer.start();
+}
+
+int MultiModelTrainer::trainStep()
+{
+    if (isFinished() || data.isEmpty()) return 0;
+
+    //stop exactly at the smallest step limit of the running models
+    qint64 count = evaluationInterval > 0 ? evaluationInterval : data.size();
+    for (int m = 0; m < models; ++m) {
+        if (finishedMs[m] < 0 && options[m].maxSteps > 0) count = qMin(count, options[m].maxSteps - steps[m]);
+    }
+
+    const std::size_t lanes = static_cast<std::size_t>(models);
+    for (qint64 s = 0; s < count; ++s) {
+        const auto& sample = data[dataIndex];
+        const double x = sample.first.first;
+        const double y = sample.first.second;
+        forward(x, y);
+        for (std::size_t m = 0; m < lanes; ++m) errorFactors[m] = sample.second - outputs[m];
+
+        //computeGradients() and updateParameters() with the models as the inner loop
+        for (int i = 0; i < maxNeurons; ++i) {
+            const std::size_t row = static_cast<std::size_t>(i) * lanes;
+            double* w = weights.data() + row;
+            double* sd = stdDevs.data() + row;
+            double* c = centers.data() + row;
+            const double* px = phiX.data() + row;
+            const double* py = phiY.data() + row;
+            const double* active = mask.data() + row;
+            const double* weightRate = weightRates.data();
+            const double* stdDevRate = stdDevRates.data();
+            const double* centerRate = centerRates.data();
+            const double* errorOf = errorFactors.data();
+            for (std::size_t m = 0; m < lanes; ++m) {
+                const double error = errorOf[m];
+                const double grad_weight = -error * (px[m] + py[m]) * active[m];
+
+                const double term1_std = (x - c[m]) * (x - c[m]) / (sd[m] * sd[m] * sd[m]);
+                const double term2_std = (y - c[m]) * (y - c[m]) / (sd[m] * sd[m] * sd[m]);
+                const double grad_stdDev = -error * w[m] * (px[m] * term1_std + py[m] * term2_std);
+
+                const double term1_center = (x - c[m]) / (sd[m] * sd[m]);
+                const double term2_center = (y - c[m]) / (sd[m] * sd[m]);
+                const double grad_center = -error * w[m] * (px[m] * term1_center + py[m] * term2_center);
+
+                w[m] -= weightRate[m] * grad_weight;
+                const double stdDev = sd[m] - stdDevRate[m] * grad_stdDev;
+                sd[m] = stdDev < 0.001 ? 0.001 : stdDev;
+                c[m] -= centerRate[m] * grad_center;
+            }
+        }
+
+        dataIndex = (dataIndex + 1) % data.size();
+    }
+    stepCounter += count;
+    for (int m = 0; m < models; ++m) {
+        if (finishedMs[m] < 0) steps[m] += count;
+    }
+
+    evaluateErrors();
+    for (int m = 0; m < models; ++m) {
+        if (finishedMs[m] >= 0) continue;
+        const bool limit = options[m].maxSteps > 0 && steps[m] >= options[m].maxSteps;
+        if (errors[m] < options[m].stopCondition || limit) {
+            //a stopped model keeps its lanes, the zero rates freeze its parameters
+            finishedMs[m] = timer.elapsed();
+            weightRates[m] = stdDevRates[m] = centerRates[m] = 0.0;
+        }
+    }
+    return static_cast<int>(count);
+}
+
+bool MultiModelTrainer::isFinished() const
+{
+    return std::none_of(finishedMs.begin(), finishedMs.end(), [](qint64 ms) { return ms < 0; });
+}
+
+qint64 MultiModelTrainer::elapsedMs() const
+{
+    return timer.elapsed();
+}
+
+bool MultiModelTrainer::supports(const TrainingOptions& options)
+{
+    //the group rate scales are applied, see weightRates
+    return options.optimizer == RRBFOptimizer::SGD && options.batchSize <= 1 && !options.levenbergMarquardt
+           && options.schedule == LearningRateSchedule::Constant && options.validationFraction <= 0.0
+           && options.basis == GaussianSumBasis && options.sparseThreshold <= 0.0
+           && options.growMaxNeurons <= 0 && options.prioritySampling <= 0.0;
+}
+
+int MultiModelTrainer::modelCount() const
+{
+    return models;
+}
+
+void MultiModelTrainer::network(int model, RRBFNetwork& out) const
+{
+    const int numNeurons = options[model].numNeurons;
+    out.numNeurons = numNeurons;
+    out.seed = options[model].seed;
+    out.basis = GaussianSumBasis;
+    out.weights.resize(numNeurons);
+    out.stdDevs.resize(numNeurons);
+    out.centers.resize(numNeurons);
+    for (int i = 0; i < numNeurons; ++i) {
+        const std::size_t k = static_cast<std::size_t>(i) * models + model;
+        out.weights[i] = weights[k];
+        out.stdDevs[i] = stdDevs[k];
+        out.centers[i] = centers[k];
+    }
+}
+
+void MultiModelTrainer::forward(double x, double y)
+{
+    //same expressions as GaussianSumKernel (basis.h)
+    const std::size_t lanes = static_cast<std::size_t>(models);
+    std::fill(outputs.begin(), outputs.end(), 0.0);
+    for (int i = 0; i < maxNeurons; ++i) {
+        const std::size_t row = static_cast<std::size_t>(i) * lanes;
+        const double* w = weights.data() + row;
+        const double* sd = stdDevs.data() + row;
+        const double* c = centers.data() + row;
+        double* px = phiX.data() + row;
+        double* py = phiY.data() + row;
+        double* out = outputs.data();
+        for (std::size_t m = 0; m < lanes; ++m) {
+            const double k = 1.0 / (2 * sd[m] * sd[m]);
+            px[m] = qExp(-(x - c[m]) * (x - c[m]) * k);
+            py[m] = qExp(-(y - c[m]) * (y - c[m]) * k);
+            out[m] += w[m] * (px[m] + py[m]);
+        }
+    }
+}
+
+void MultiModelTrainer::evaluateErrors()
+{
+    std::vector<double> sums(models, 0.0);
+    for (const auto& sample : data) {
+        forward(sample.first.first, sample.first.second);
+        for (int m = 0; m < models; ++m) {
+            const double error = sample.second - outputs[m];
+            sums[m] += 0.5 * error * error;
+        }
+    }
+    for (int m = 0; m < models; ++m) errors[m] = data.isEmpty() ? 0.0 : sums[m] / data.size();
+}
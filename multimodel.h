@@ -0,0 +1,66 @@
+#ifndef MULTIMODEL_H
+#define MULTIMODEL_H
+
+#include "rrbftrainer.h"
+
+#include <QElapsedTimer>
+#include <vector>
+
+// Per-sample SGD on many independent RRBF models at once. The parameters are
+// interleaved model-minor, element [neuron * modelCount + model], so the
+// inner loop of every kernel runs over the models: each sample is read once
+// for all of them and the compiler can map the models to SIMD lanes.
+// Models with fewer neurons than the largest one are padded with masked
+// neurons that keep a zero weight and never change the output.
+//
+// Per model the steps match RRBFTrainer with plain SGD and batch size 1
+// (same sample order, same expressions, stdDevs clamped at 0.001); the
+// learning rate, group rate scales, seed, init and solveWeights come from
+// the model's options. Other optimizers, schedules, mini-batches, LM,
+// validation splits, sparse gradients, growing networks, prioritized sampling
+// and basis functions other than GaussianSumBasis are not supported and
+// ignored. The training error is only evaluated every evaluationInterval
+// steps, a model stops at the first evaluation below its stopCondition or
+// when maxSteps is reached.
+class MultiModelTrainer
+{
+public:
+    explicit MultiModelTrainer(const TrainingSet& data_);
+
+    void start(const QVector<TrainingOptions>& options_);
+    // trains up to evaluationInterval samples on every running model, then
+    // evaluates the errors; returns the number of samples trained
+    int trainStep();
+    bool isFinished() const;
+    qint64 elapsedMs() const;
+
+    int modelCount() const;
+    // false for the options start() would ignore, such runs need RRBFTrainer
+    static bool supports(const TrainingOptions& options);
+    // the current parameters of one model as a regular network
+    void network(int model, RRBFNetwork& out) const;
+
+    QVector<TrainingOptions> options;   // seeds resolved like RRBFTrainer::start()
+    QVector<double> errors;             // training error at the last evaluation
+    QVector<qint64> steps;              // samples trained per model
+    QVector<qint64> finishedMs;         // elapsed time when the model stopped, -1 while running
+    int evaluationInterval;             // samples between two error evaluations, 0 = one epoch
+    int dataIndex;
+    qint64 stepCounter;                 // samples fed so far
+
+private:
+    void forward(double x, double y);   // fills phiX, phiY and outputs
+    void evaluateErrors();
+
+    const TrainingSet& data;
+    int models;         // lanes, one per model
+    int maxNeurons;
+    std::vector<double> weights, stdDevs, centers;  // [neuron * models + model]
+    std::vector<double> mask;                       // 1 for real neurons, 0 for padding
+    std::vector<double> weightRates, stdDevRates, centerRates; // per model, 0 once stopped
+    std::vector<double> phiX, phiY;                 // of the last forward pass
+    std::vector<double> outputs, errorFactors;      // per model
+    QElapsedTimer timer;
+};
+
+#endif // MULTIMODEL_H
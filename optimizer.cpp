@@ -0,0 +1,148 @@
+#include "optimizer.h"
+
+RRBFOptimizer::RRBFOptimizer()
+{
+    type = SGD;
+    momentum = 0.9;
+    beta2 = 0.999;
+    decay = 0.9;
+    epsilon = 1e-8;
+    weightsRateScale = 1.0;
+    stdDevsRateScale = 1.0;
+    centersRateScale = 1.0;
+    stepCounter = 0;
+    beta1Power = 1.0;
+    beta2Power = 1.0;
+}
+
+void RRBFOptimizer::reset(Type type_, int numNeurons)
+{
+    type = type_;
+
+    for (State* state : { &weightState, &stdDevState, &centerState }) {
+        state->first.fill(0.0, numNeurons);
+        state->second.fill(0.0, numNeurons);
+    }
+    stepCounter = 0;
+    beta1Power = 1.0;
+    beta2Power = 1.0;
+}
+
+void RRBFOptimizer::resize(int numNeurons)
+{
+    for (State* state : { &weightState, &stdDevState, &centerState }) {
+        state->first.resize(numNeurons);
+        state->second.resize(numNeurons);
+    }
+}
+
+void RRBFOptimizer::step(RRBFNetwork& network, const QVector<double>& grad_weights, const QVector<double>& grad_stdDevs, const QVector<double>& grad_centers, double learningRate)
+{
+    const bool uniformRate = weightsRateScale == 1.0 && stdDevsRateScale == 1.0 && centersRateScale == 1.0;
+    if (type == SGD && uniformRate) {
+        network.updateParameters(grad_weights, grad_stdDevs, grad_centers, learningRate);
+        return;
+    }
+
+    const int n = network.numNeurons;
+    if (weightState.first.size() != n) reset(type, n);
+
+    stepCounter++;
+    beta1Power *= momentum;
+    beta2Power *= beta2;
+
+    updateArray(network.weights.data(), grad_weights.constData(), weightState, n, learningRate * weightsRateScale);
+    updateArray(network.stdDevs.data(), grad_stdDevs.constData(), stdDevState, n, learningRate * stdDevsRateScale);
+    updateArray(network.centers.data(), grad_centers.constData(), centerState, n, learningRate * centersRateScale);
+
+    //standart deviation must stay positive
+    double* stdDevs = network.stdDevs.data();
+    for (int i = 0; i < n; ++i) {
+        if (stdDevs[i] < 0.001) stdDevs[i] = 0.001;
+    }
+}
+
+void RRBFOptimizer::sparseStep(RRBFNetwork& network, const QVector<int>& neurons, const QVector<double>& grad_weights, const QVector<double>& grad_stdDevs, const QVector<double>& grad_centers, double learningRate)
+{
+    const double rateWeights = learningRate * weightsRateScale;
+    const double rateStdDevs = learningRate * stdDevsRateScale;
+    const double rateCenters = learningRate * centersRateScale;
+    double* weights = network.weights.data();
+    double* stdDevs = network.stdDevs.data();
+    double* centers = network.centers.data();
+    for (int i : neurons) {
+        weights[i] -= rateWeights * grad_weights[i];
+        stdDevs[i] -= rateStdDevs * grad_stdDevs[i];
+        centers[i] -= rateCenters * grad_centers[i];
+
+        //standart deviation must stay positive
+        if (stdDevs[i] < 0.001) stdDevs[i] = 0.001;
+    }
+}
+
+void RRBFOptimizer::updateArray(double* params, const double* grads, State& state, int n, double learningRate)
+{
+    double* first = state.first.data();
+    double* second = state.second.data();
+
+    switch (type) {
+    case Momentum:
+        for (int i = 0; i < n; ++i) {
+            first[i] = momentum * first[i] - learningRate * grads[i];
+            params[i] += first[i];
+        }
+        break;
+    case Nesterov:
+        //look-ahead form: p += -mu * v_old + (1 + mu) * v_new
+        for (int i = 0; i < n; ++i) {
+            double previous = first[i];
+            first[i] = momentum * first[i] - learningRate * grads[i];
+            params[i] += -momentum * previous + (1.0 + momentum) * first[i];
+        }
+        break;
+    case Adam: {
+        double stepSize = learningRate * qSqrt(1.0 - beta2Power) / (1.0 - beta1Power);
+        for (int i = 0; i < n; ++i) {
+            first[i] = momentum * first[i] + (1.0 - momentum) * grads[i];
+            second[i] = beta2 * second[i] + (1.0 - beta2) * grads[i] * grads[i];
+            params[i] -= stepSize * first[i] / (qSqrt(second[i]) + epsilon);
+        }
+        break;
+    }
+    case RMSProp:
+        for (int i = 0; i < n; ++i) {
+            second[i] = decay * second[i] + (1.0 - decay) * grads[i] * grads[i];
+            params[i] -= learningRate * grads[i] / (qSqrt(second[i]) + epsilon);
+        }
+        break;
+    case SGD:
+        for (int i = 0; i < n; ++i) {
+            params[i] -= learningRate * grads[i];
+        }
+        break;
+    }
+}
+
+RRBFOptimizer::Type RRBFOptimizer::typeFromName(const QString& name, bool* ok)
+{
+    QString lower = name.toLower();
+    if (ok) *ok = true;
+    if (lower == "momentum") return Momentum;
+    if (lower == "nesterov") return Nesterov;
+    if (lower == "adam") return Adam;
+    if (lower == "rmsprop") return RMSProp;
+    if (ok) *ok = lower == "sgd";
+    return SGD;
+}
+
+QString RRBFOptimizer::typeName(Type type)
+{
+    switch (type) {
+    case Momentum: return "momentum";
+    case Nesterov: return "nesterov";
+    case Adam: return "adam";
+    case RMSProp: return "rmsprop";
+    case SGD: break;
+    }
+    return "sgd";
+}
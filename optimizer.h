@@ -0,0 +1,59 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "rrbfnetwork.h"
+
+// gradient step rules for RRBFNetwork parameters. The optimizer state is kept
+// as one array per parameter array (weights, stdDevs, centers) so every
+// update is a plain loop over contiguous doubles.
+class RRBFOptimizer
+{
+public:
+    enum Type { SGD, Momentum, Nesterov, Adam, RMSProp };
+
+    RRBFOptimizer();
+
+    Type type;
+    double momentum;    // Momentum/Nesterov coefficient, Adam beta1
+    double beta2;       // Adam second moment decay
+    double decay;       // RMSProp second moment decay
+    double epsilon;
+    // per parameter group factors on the learning rate
+    double weightsRateScale;
+    double stdDevsRateScale;
+    double centersRateScale;
+
+    void reset(Type type_, int numNeurons);
+    // keeps the state of the existing neurons, added neurons start at zero
+    void resize(int numNeurons);
+    void step(RRBFNetwork& network,
+              const QVector<double>& grad_weights,
+              const QVector<double>& grad_stdDevs,
+              const QVector<double>& grad_centers,
+              double learningRate);
+    // SGD on the listed neurons only, gradients indexed by neuron (sparse training)
+    void sparseStep(RRBFNetwork& network, const QVector<int>& neurons,
+                    const QVector<double>& grad_weights,
+                    const QVector<double>& grad_stdDevs,
+                    const QVector<double>& grad_centers,
+                    double learningRate);
+
+    // other names than sgd, momentum, nesterov, adam or rmsprop give SGD and *ok = false
+    static Type typeFromName(const QString& name, bool* ok = nullptr);
+    static QString typeName(Type type);
+
+private:
+    struct State
+    {
+        QVector<double> first;  // velocity or first moment
+        QVector<double> second; // second moment
+    };
+
+    void updateArray(double* params, const double* grads, State& state, int n, double learningRate);
+
+    State weightState, stdDevState, centerState;
+    qint64 stepCounter;
+    double beta1Power, beta2Power; // beta^t for the Adam bias correction
+};
+
+#endif // OPTIMIZER_H
@@ -0,0 +1,135 @@
+#include "perfcounters.h"
+
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other)
+{
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cacheMisses += other.cacheMisses;
+    branchMisses += other.branchMisses;
+    return *this;
+}
+
+PerfCounters::PerfCounters()
+{
+    for (int& fd : fds) fd = -1;
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef Q_OS_LINUX
+    for (int fd : fds) {
+        if (fd >= 0) close(fd);
+    }
+#endif
+}
+
+bool PerfCounters::open()
+{
+#ifdef Q_OS_LINUX
+    if (isOpen()) {
+        reset();
+        return true;
+    }
+
+    const quint64 configs[4] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                 PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    for (int i = 0; i < 4; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.disabled = (i == 0) ? 1 : 0; //the group leader starts and stops all
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+        if (fds[i] < 0) {
+            error = QString("perf_event_open failed: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+            for (int& fd : fds) {
+                if (fd >= 0) close(fd);
+                fd = -1;
+            }
+            return false;
+        }
+    }
+    reset();
+    return true;
+#else
+    error = "hardware counters need Linux perf_event_open";
+    return false;
+#endif
+}
+
+bool PerfCounters::isOpen() const
+{
+    return fds[0] >= 0;
+}
+
+QString PerfCounters::errorString() const
+{
+    return error;
+}
+
+void PerfCounters::reset()
+{
+#ifdef Q_OS_LINUX
+    if (isOpen()) ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void PerfCounters::start()
+{
+#ifdef Q_OS_LINUX
+    if (isOpen()) ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void PerfCounters::stop()
+{
+#ifdef Q_OS_LINUX
+    if (isOpen()) ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+PerfCounterValues PerfCounters::read() const
+{
+    PerfCounterValues values;
+#ifdef Q_OS_LINUX
+    if (!isOpen()) return values;
+
+    //PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+    quint64 buffer[3 + 4];
+    if (::read(fds[0], buffer, sizeof(buffer)) < static_cast<ssize_t>(sizeof(buffer))) return values;
+
+    double scale = (buffer[2] > 0) ? double(buffer[1]) / buffer[2] : 1.0;
+    values.cycles = static_cast<quint64>(buffer[3] * scale);
+    values.instructions = static_cast<quint64>(buffer[4] * scale);
+    values.cacheMisses = static_cast<quint64>(buffer[5] * scale);
+    values.branchMisses = static_cast<quint64>(buffer[6] * scale);
+#endif
+    return values;
+}
+
+QString PerfCounters::format(const PerfCounterValues& values, double perUnit, const QString& unit)
+{
+    QString text = QString("cycles %1, instructions %2, IPC %3, cache misses %4, branch misses %5")
+            .arg(values.cycles).arg(values.instructions).arg(values.ipc(), 0, 'f', 2)
+            .arg(values.cacheMisses).arg(values.branchMisses);
+    if (perUnit > 0.0) {
+        text += QString(" | per %1: cycles %2, cache misses %3, branch misses %4").arg(unit)
+                .arg(values.cycles / perUnit, 0, 'f', 1).arg(values.cacheMisses / perUnit, 0, 'f', 3)
+                .arg(values.branchMisses / perUnit, 0, 'f', 3);
+    }
+    return text;
+}
@@ -0,0 +1,47 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QString>
+
+struct PerfCounterValues
+{
+    quint64 cycles = 0;
+    quint64 instructions = 0;
+    quint64 cacheMisses = 0;
+    quint64 branchMisses = 0;
+
+    double ipc() const { return cycles ? double(instructions) / cycles : 0.0; }
+    PerfCounterValues& operator+=(const PerfCounterValues& other);
+};
+
+// Hardware counters of the calling thread via Linux perf_event_open, opened
+// as one group so all four counters cover exactly the same intervals.
+// Counting accumulates over all start()/stop() pairs. On other systems, or
+// when perf events are not permitted (kernel.perf_event_paranoid), open()
+// returns false and errorString() says why.
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    bool open();
+    bool isOpen() const;
+    QString errorString() const;
+
+    void reset();
+    void start();
+    void stop();
+    PerfCounterValues read() const; // scaled if the kernel had to multiplex
+
+    static QString format(const PerfCounterValues& values, double perUnit = 0.0, const QString& unit = QString());
+
+private:
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    int fds[4];
+    QString error;
+};
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,232 @@
+#include "predictor.h"
+#include "rrbfnetwork.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+RRBFPredictor::RRBFPredictor()
+{
+    cullTolerance = 0.0;
+    basis = GaussianSumBasis;
+}
+
+RRBFPredictor::RRBFPredictor(const RRBFNetwork& network)
+{
+    assign(network.weights.constData(), network.centers.constData(), network.stdDevs.constData(), network.numNeurons,
+           network.basis);
+}
+
+RRBFPredictor::RRBFPredictor(const double* weights_, const double* centers_, const double* stdDevs_, int numNeurons,
+                             BasisFunction basis_)
+{
+    assign(weights_, centers_, stdDevs_, numNeurons, basis_);
+}
+
+void RRBFPredictor::assign(const double* weights_, const double* centers_, const double* stdDevs_, int numNeurons,
+                           BasisFunction basis_)
+{
+    cullTolerance = 0.0;
+    basis = basis_;
+    weights.assign(weights_, weights_ + numNeurons);
+    centers.assign(centers_, centers_ + numNeurons);
+    inverseTwoVariance.resize(numNeurons);
+    for (int i = 0; i < numNeurons; ++i) {
+        inverseTwoVariance[i] = 1.0 / (2.0 * stdDevs_[i] * stdDevs_[i]);
+    }
+}
+
+int RRBFPredictor::numNeurons() const
+{
+    return static_cast<int>(weights.size());
+}
+
+template <class Kernel>
+double RRBFPredictor::sumNeurons(double x, double y) const
+{
+    const int n = numNeurons();
+    const double* w = weights.data();
+    const double* m = centers.data();
+    const double* k = inverseTwoVariance.data();
+
+    double output = 0.0;
+    for (int i = 0; i < n; ++i) {
+        output += w[i] * Kernel::phi(x - m[i], y - m[i], k[i]);
+    }
+    return output;
+}
+
+double RRBFPredictor::predict(double x, double y) const
+{
+    if (cullTolerance > 0.0) return predictCulled(x, y);
+
+    switch (basis) {
+    case RadialGaussianBasis: return sumNeurons<RadialGaussianKernel>(x, y);
+    case WendlandBasis: return sumNeurons<WendlandKernel>(x, y);
+    case InverseMultiquadricBasis: return sumNeurons<InverseMultiquadricKernel>(x, y);
+    case GaussianSumBasis: break;
+    }
+    return sumNeurons<GaussianSumKernel>(x, y);
+}
+
+void RRBFPredictor::predict(const double* xs, const double* ys, double* outputs, std::size_t count) const
+{
+    if (cullTolerance > 0.0) {
+        for (std::size_t s = 0; s < count; ++s) outputs[s] = predictCulled(xs[s], ys[s]);
+        return;
+    }
+
+    switch (basis) {
+    case RadialGaussianBasis: predictBlocks<RadialGaussianKernel>(xs, ys, outputs, count); return;
+    case WendlandBasis: predictBlocks<WendlandKernel>(xs, ys, outputs, count); return;
+    case InverseMultiquadricBasis: predictBlocks<InverseMultiquadricKernel>(xs, ys, outputs, count); return;
+    case GaussianSumBasis: break;
+    }
+    predictBlocks<GaussianSumKernel>(xs, ys, outputs, count);
+}
+
+template <class Kernel>
+void RRBFPredictor::predictBlocks(const double* xs, const double* ys, double* outputs, std::size_t count) const
+{
+    const int n = numNeurons();
+    const double* w = weights.data();
+    const double* m = centers.data();
+    const double* k = inverseTwoVariance.data();
+
+    //neurons outside, a block of samples inside: every neuron is loaded once
+    //per block and the inner loop is a flat loop over contiguous samples
+    for (std::size_t begin = 0; begin < count; begin += blockSize) {
+        const std::size_t size = std::min(blockSize, count - begin);
+        const double* x = xs + begin;
+        const double* y = ys + begin;
+        double* out = outputs + begin;
+        for (std::size_t s = 0; s < size; ++s) out[s] = 0.0;
+
+        for (int i = 0; i < n; ++i) {
+            const double wi = w[i], mi = m[i], ki = k[i];
+            for (std::size_t s = 0; s < size; ++s) {
+                out[s] += wi * Kernel::phi(x[s] - mi, y[s] - mi, ki);
+            }
+        }
+    }
+}
+
+void RRBFPredictor::predict(const double* xy, double* outputs, std::size_t count) const
+{
+    double xs[blockSize], ys[blockSize];
+    for (std::size_t begin = 0; begin < count; begin += blockSize) {
+        const std::size_t size = std::min(blockSize, count - begin);
+        for (std::size_t s = 0; s < size; ++s) {
+            xs[s] = xy[2 * (begin + s)];
+            ys[s] = xy[2 * (begin + s) + 1];
+        }
+        predict(xs, ys, outputs + begin, size);
+    }
+}
+
+double RRBFPredictor::nsPerPrediction(const double* xs, const double* ys, std::size_t count, int repeats) const
+{
+    if (count == 0 || repeats <= 0) return 0.0;
+    std::vector<double> outputs(count);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) predict(xs, ys, outputs.data(), count);
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (static_cast<double>(repeats) * count);
+}
+
+void RRBFPredictor::enableCulling(double tolerance)
+{
+    cullTolerance = tolerance > 0.0 && basis == GaussianSumBasis ? tolerance : 0.0;
+    bands.clear();
+    sortedCenters.clear();
+    sortedWeights.clear();
+    sortedInverseTwoVariance.clear();
+    if (cullTolerance == 0.0 || weights.empty()) return;
+
+    //band b holds delta in [minDelta * 2^b, minDelta * 2^(b+1))
+    const int n = numNeurons();
+    std::vector<double> stdDevs(n);
+    for (int i = 0; i < n; ++i) stdDevs[i] = std::sqrt(0.5 / inverseTwoVariance[i]);
+    const double minDelta = *std::min_element(stdDevs.begin(), stdDevs.end());
+
+    std::vector<int> bandOf(n);
+    int numBands = 0;
+    for (int i = 0; i < n; ++i) {
+        bandOf[i] = static_cast<int>(std::floor(std::log2(stdDevs[i] / minDelta)));
+        numBands = std::max(numBands, bandOf[i] + 1);
+    }
+
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return bandOf[a] != bandOf[b] ? bandOf[a] < bandOf[b] : centers[a] < centers[b];
+    });
+
+    std::size_t position = 0;
+    for (int b = 0; b < numBands; ++b) {
+        Band band;
+        band.begin = position;
+        double maxDelta = 0.0, maxWeight = 0.0;
+        while (position < order.size() && bandOf[order[position]] == b) {
+            int i = order[position++];
+            sortedCenters.push_back(centers[i]);
+            sortedWeights.push_back(weights[i]);
+            sortedInverseTwoVariance.push_back(inverseTwoVariance[i]);
+            maxDelta = std::max(maxDelta, stdDevs[i]);
+            maxWeight = std::max(maxWeight, std::fabs(weights[i]));
+        }
+        band.end = position;
+        if (band.begin == band.end) continue;
+
+        //|w| exp(-d^2 / 2 delta^2) < tolerance  <=>  d > delta sqrt(2 ln(|w| / tolerance))
+        band.radius = maxWeight > cullTolerance ? maxDelta * std::sqrt(2.0 * std::log(maxWeight / cullTolerance)) : -1.0;
+        bands.push_back(band);
+    }
+}
+
+bool RRBFPredictor::isCulling() const
+{
+    return cullTolerance > 0.0;
+}
+
+double RRBFPredictor::sumAxis(double v) const
+{
+    const double* m = sortedCenters.data();
+    const double* w = sortedWeights.data();
+    const double* k = sortedInverseTwoVariance.data();
+
+    double sum = 0.0;
+    for (const Band& band : bands) {
+        if (band.radius < 0.0) continue;
+        std::size_t i = std::lower_bound(m + band.begin, m + band.end, v - band.radius) - m;
+        const double upper = v + band.radius;
+        for (; i < band.end && m[i] <= upper; ++i) {
+            double d = v - m[i];
+            sum += w[i] * std::exp(-d * d * k[i]);
+        }
+    }
+    return sum;
+}
+
+double RRBFPredictor::predictCulled(double x, double y) const
+{
+    return sumAxis(x) + sumAxis(y);
+}
+
+double RRBFPredictor::culledFraction(const double* xs, const double* ys, std::size_t count) const
+{
+    if (!isCulling() || count == 0 || weights.empty()) return 1.0;
+
+    const double* m = sortedCenters.data();
+    std::size_t evaluated = 0;
+    for (std::size_t s = 0; s < count; ++s) {
+        for (double v : { xs[s], ys[s] }) {
+            for (const Band& band : bands) {
+                if (band.radius < 0.0) continue;
+                evaluated += std::upper_bound(m + band.begin, m + band.end, v + band.radius)
+                             - std::lower_bound(m + band.begin, m + band.end, v - band.radius);
+            }
+        }
+    }
+    return double(evaluated) / (2.0 * count * weights.size());
+}
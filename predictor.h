@@ -0,0 +1,77 @@
+#ifndef PREDICTOR_H
+#define PREDICTOR_H
+
+#include "basis.h"
+
+#include <cstddef>
+#include <vector>
+
+class RRBFNetwork;
+
+// Batch inference on a trained model, arrays in and arrays out, no Qt types
+// in the interface. The parameters are copied into plain arrays with
+// 1 / (2 delta^2) precomputed, so predict() does no divisions and the
+// network may change or go away afterwards. predict() is const and safe to
+// call from several threads. The loops are templates on the basis function
+// policy of the model (basis.h).
+class RRBFPredictor
+{
+public:
+    RRBFPredictor();
+    explicit RRBFPredictor(const RRBFNetwork& network);
+    RRBFPredictor(const double* weights, const double* centers, const double* stdDevs, int numNeurons,
+                  BasisFunction basis = GaussianSumBasis);
+
+    int numNeurons() const;
+
+    // outputs[i] = f(xs[i], ys[i]) for i < count
+    void predict(const double* xs, const double* ys, double* outputs, std::size_t count) const;
+    // interleaved input, xy = x0, y0, x1, y1, ...
+    void predict(const double* xy, double* outputs, std::size_t count) const;
+    double predict(double x, double y) const;
+    // mean wall time of one prediction in predict(xs, ys, ...) over these
+    // samples, the batch repeated for a stable figure
+    double nsPerPrediction(const double* xs, const double* ys, std::size_t count, int repeats = 20) const;
+
+    static const std::size_t blockSize = 64; // samples per pass over the neurons
+
+    // Culled evaluation. phi_i is a pure x term plus a pure y term, so the
+    // output is two 1D sums over the neurons and every term with
+    // |w_i| exp(-d^2 / 2 delta_i^2) < tolerance can be left out. The neurons
+    // are sorted by center within bands of delta (factor 2 apart), a binary
+    // search per band finds the ones within the band's cut-off radius of x
+    // and of y. The error is at most 2 * tolerance per skipped neuron;
+    // tolerance 0 switches culling off again. Only GaussianSumBasis splits
+    // that way, culling is ignored for the other bases.
+    void enableCulling(double tolerance);
+    bool isCulling() const;
+    // share of the neuron terms the culled evaluation computes for these samples
+    double culledFraction(const double* xs, const double* ys, std::size_t count) const;
+
+private:
+    struct Band
+    {
+        std::size_t begin, end; // range in the sorted arrays
+        double radius;          // |center - v| beyond this is below the tolerance, < 0: skip the band
+    };
+
+    void assign(const double* weights_, const double* centers_, const double* stdDevs_, int numNeurons,
+                BasisFunction basis_);
+    template <class Kernel>
+    double sumNeurons(double x, double y) const;
+    template <class Kernel>
+    void predictBlocks(const double* xs, const double* ys, double* outputs, std::size_t count) const;
+    double predictCulled(double x, double y) const;
+    double sumAxis(double v) const;
+
+    std::vector<double> weights;
+    std::vector<double> centers;
+    std::vector<double> inverseTwoVariance; // 1 / (2 delta_i^2)
+    BasisFunction basis;
+
+    double cullTolerance;
+    std::vector<Band> bands;
+    std::vector<double> sortedCenters, sortedWeights, sortedInverseTwoVariance;
+};
+
+#endif // PREDICTOR_H
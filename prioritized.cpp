@@ -0,0 +1,53 @@
+#include "rrbftrainer.h"
+
+// Prioritized sampling for the dense gradient steps. Instead of walking
+// trainingData in order, every sample is drawn with probability
+//   P(i) = (1 - u) * p_i / sum(p) + u / N,   p_i = |residual_i|^alpha
+// from a sum tree over the p_i, with alpha = options.prioritySampling and
+// u = uniformShare. The uniform share keeps every sample reachable and
+// bounds the importance weight w_i = (N * P(i))^-beta, beta =
+// options.priorityCorrection, by u^-beta; with beta = 1 the expected
+// weighted gradient is the plain mean gradient over the data. The priority
+// of a drawn sample is updated with its residual before the step, all of
+// them are refreshed once per epoch.
+
+namespace {
+const double uniformShare = 0.1;
+}
+
+void RRBFTrainer::resetPriorities()
+{
+    priorities.reset(trainingData.size());
+    for (int j = 0; j < trainingData.size(); ++j) {
+        const auto& sample = trainingData[j];
+        double residual = sample.second - network.computeOutput(sample.first.first, sample.first.second);
+        priorities.set(j, qPow(qAbs(residual), options.prioritySampling));
+    }
+}
+
+int RRBFTrainer::drawSample(double& importance)
+{
+    const int n = trainingData.size();
+    const double total = priorities.total();
+    int index;
+    if (total <= 0.0 || sampleRng.generateDouble() < uniformShare) {
+        index = sampleRng.bounded(n);
+    } else {
+        index = priorities.find(sampleRng.generateDouble() * total);
+    }
+
+    const double p = total > 0.0 ? (1.0 - uniformShare) * priorities.priority(index) / total + uniformShare / n
+                                 : 1.0 / n;
+    importance = qPow(n * p, -options.priorityCorrection);
+    return index;
+}
+
+void RRBFTrainer::prioritizeSample(int index, double residual, double importance)
+{
+    priorities.set(index, qPow(qAbs(residual), options.prioritySampling));
+    for (int i = 0; i < network.numNeurons; ++i) {
+        grad_weights[i] *= importance;
+        grad_stdDevs[i] *= importance;
+        grad_centers[i] *= importance;
+    }
+}
@@ -0,0 +1,183 @@
+#include "profiler.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const char* phaseNames[PhaseCount] = { "gradient", "update", "error pass", "solve", "drawGraph", "processEvents" };
+
+// bucket b holds durations in [2^b, 2^(b+1)) ns, 2^40 ns is ~18 minutes
+const int histogramBuckets = 41;
+
+// one phase merged over all threads, for report()
+struct PhaseStats
+{
+    qint64 count = 0;
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+    qint64 histogram[histogramBuckets] = {};
+};
+
+// the counters of one thread. The thread is their only writer and updates
+// them with relaxed loads and stores, no read-modify-write; report(), totals()
+// and reset() may run on another thread at the same time and see each
+// counter either before or after an update. A reset() racing with a record()
+// can leave that one record in the counters.
+struct ThreadStats
+{
+    struct Phase
+    {
+        std::atomic<qint64> count, totalNs, maxNs;
+        std::atomic<qint64> histogram[histogramBuckets];
+    };
+    Phase phases[PhaseCount];
+
+    ThreadStats() { clear(); }
+
+    void clear()
+    {
+        for (Phase& phase : phases) {
+            phase.count.store(0, std::memory_order_relaxed);
+            phase.totalNs.store(0, std::memory_order_relaxed);
+            phase.maxNs.store(0, std::memory_order_relaxed);
+            for (auto& bucket : phase.histogram) bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+void add(std::atomic<qint64>& counter, qint64 value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+QMutex registryMutex;
+std::vector<std::unique_ptr<ThreadStats>> registry; // all threads that ever recorded
+
+ThreadStats* threadStats()
+{
+    thread_local ThreadStats* stats = nullptr;
+    if (!stats) {
+        QMutexLocker locker(&registryMutex);
+        registry.emplace_back(new ThreadStats());
+        stats = registry.back().get();
+    }
+    return stats;
+}
+
+int bucketOf(qint64 nanoseconds)
+{
+    int bucket = 0;
+    while (nanoseconds > 1 && bucket < histogramBuckets - 1) {
+        nanoseconds >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+//upper bound of the bucket holding the given quantile
+qint64 quantileNs(const PhaseStats& stats, double quantile)
+{
+    qint64 target = static_cast<qint64>(quantile * stats.count);
+    qint64 seen = 0;
+    for (int b = 0; b < histogramBuckets; ++b) {
+        seen += stats.histogram[b];
+        if (seen > target) return qMin(stats.maxNs, qint64(1) << (b + 1));
+    }
+    return stats.maxNs;
+}
+
+QString formatNs(qint64 nanoseconds)
+{
+    if (nanoseconds < 10000) return QString("%1 ns").arg(nanoseconds);
+    if (nanoseconds < 10000000) return QString("%1 us").arg(nanoseconds / 1000.0, 0, 'f', 1);
+    return QString("%1 ms").arg(nanoseconds / 1000000.0, 0, 'f', 1);
+}
+
+}
+
+void Profiler::record(ProfilePhase phase, qint64 nanoseconds)
+{
+    ThreadStats::Phase& stats = threadStats()->phases[phase];
+    add(stats.count, 1);
+    add(stats.totalNs, nanoseconds);
+    if (nanoseconds > stats.maxNs.load(std::memory_order_relaxed)) stats.maxNs.store(nanoseconds, std::memory_order_relaxed);
+    add(stats.histogram[bucketOf(nanoseconds)], 1);
+}
+
+void Profiler::reset()
+{
+    QMutexLocker locker(&registryMutex);
+    for (auto& stats : registry) stats->clear();
+}
+
+QString Profiler::report()
+{
+    if (!isEnabled()) return "Profiling is disabled in this build (CONFIG += rrbf_profiling).";
+
+    PhaseStats merged[PhaseCount];
+    {
+        QMutexLocker locker(&registryMutex);
+        for (const auto& thread : registry) {
+            for (int p = 0; p < PhaseCount; ++p) {
+                const ThreadStats::Phase& stats = thread->phases[p];
+                merged[p].count += stats.count.load(std::memory_order_relaxed);
+                merged[p].totalNs += stats.totalNs.load(std::memory_order_relaxed);
+                merged[p].maxNs = qMax(merged[p].maxNs, stats.maxNs.load(std::memory_order_relaxed));
+                for (int b = 0; b < histogramBuckets; ++b) {
+                    merged[p].histogram[b] += stats.histogram[b].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    qint64 totalNs = 0;
+    for (int p = 0; p < PhaseCount; ++p) totalNs += merged[p].totalNs;
+
+    QStringList lines;
+    lines << QString("%1%2%3%4%5%6").arg(QString("phase"), -14).arg(QString("calls"), -9).arg(QString("total"), -11)
+             .arg(QString("mean"), -11).arg(QString("p50"), -11).arg(QString("p99 / share"));
+    for (int p = 0; p < PhaseCount; ++p) {
+        const PhaseStats& stats = merged[p];
+        if (stats.count == 0) continue;
+        lines << QString("%1%2%3%4%5%6 / %7%").arg(QString(phaseNames[p]), -14).arg(stats.count, -9)
+                 .arg(formatNs(stats.totalNs), -11).arg(formatNs(stats.totalNs / stats.count), -11)
+                 .arg(formatNs(quantileNs(stats, 0.5)), -11).arg(formatNs(quantileNs(stats, 0.99)))
+                 .arg(totalNs > 0 ? 100.0 * stats.totalNs / totalNs : 0.0, 0, 'f', 1);
+    }
+    return lines.join('\n');
+}
+
+void Profiler::totals(qint64 counts[PhaseCount], qint64 totalNs[PhaseCount])
+{
+    for (int p = 0; p < PhaseCount; ++p) {
+        counts[p] = 0;
+        totalNs[p] = 0;
+    }
+    QMutexLocker locker(&registryMutex);
+    for (const auto& thread : registry) {
+        for (int p = 0; p < PhaseCount; ++p) {
+            counts[p] += thread->phases[p].count.load(std::memory_order_relaxed);
+            totalNs[p] += thread->phases[p].totalNs.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+const char* Profiler::phaseName(ProfilePhase phase)
+{
+    return phaseNames[phase];
+}
+
+bool Profiler::isEnabled()
+{
+#ifdef RRBF_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
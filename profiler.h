@@ -0,0 +1,57 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QString>
+#include <chrono>
+
+// Lightweight per-phase timing of the training loop. Each thread records
+// into its own counters and log2 histograms, report() merges them, also
+// while other threads are still recording.
+// Build without RRBF_PROFILING (CONFIG -= rrbf_profiling) to compile the
+// timers out completely.
+
+enum ProfilePhase {
+    PhaseGradient,      // computeGradients
+    PhaseUpdate,        // optimizer / updateParameters
+    PhaseError,         // full error pass over the training set
+    PhaseSolve,         // least squares and Levenberg-Marquardt solves
+    PhaseDraw,          // drawGraph
+    PhaseEvents,        // QApplication::processEvents
+    PhaseCount
+};
+
+namespace Profiler {
+    void record(ProfilePhase phase, qint64 nanoseconds);
+    void reset();
+    QString report();
+    bool isEnabled();
+    // calls and total time per phase, summed over all threads
+    void totals(qint64 counts[PhaseCount], qint64 totalNs[PhaseCount]);
+    const char* phaseName(ProfilePhase phase);
+}
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfilePhase phase_)
+        : phase(phase_), start(std::chrono::steady_clock::now()) {}
+    ~ProfileScope()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        Profiler::record(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+private:
+    ProfilePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define RRBF_PROFILE_CONCAT2(a, b) a##b
+#define RRBF_PROFILE_CONCAT(a, b) RRBF_PROFILE_CONCAT2(a, b)
+#ifdef RRBF_PROFILING
+#define RRBF_PROFILE_SCOPE(phase) ProfileScope RRBF_PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#else
+#define RRBF_PROFILE_SCOPE(phase) do {} while (0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,73 @@
+#include "rrbfnetwork.h"
+
+#include <algorithm>
+
+// Post-training compression. A neuron whose RMS contribution w_i phi_i over
+// the data is below pruneTolerance is dropped. Neurons with nearly the same
+// center and stdDev compute nearly the same phi, so they are merged into one
+// neuron with the summed weight and the |w| weighted mean center and stdDev.
+// Pruning runs first, so that negligible neurons do not move the merged
+// ones. Finally the weights are re-fitted by ridge regression, kept only if
+// that lowers the error on the data.
+
+int RRBFNetwork::compress(const TrainingSet& data, double pruneTolerance, double mergeTolerance)
+{
+    if (numNeurons == 0 || data.isEmpty()) return 0;
+    const int originalNeurons = numNeurons;
+
+    //RMS contribution of every neuron over the data
+    QVector<double> contribution(numNeurons, 0.0);
+    for (const auto& sample : data) {
+        for (int i = 0; i < numNeurons; ++i) {
+            double term = weights[i] * computePhi(i, sample.first.first, sample.first.second);
+            contribution[i] += term * term;
+        }
+    }
+    QVector<int> kept;
+    for (int i = 0; i < numNeurons; ++i) {
+        contribution[i] = qSqrt(contribution[i] / data.size());
+        if (contribution[i] >= pruneTolerance) kept.append(i);
+    }
+    if (kept.isEmpty()) {
+        //never prune everything, the strongest neuron stays
+        kept.append(static_cast<int>(std::max_element(contribution.begin(), contribution.end()) - contribution.begin()));
+    }
+
+    //merge neighbours in center order while center and stdDev are within tolerance
+    std::sort(kept.begin(), kept.end(), [this](int a, int b) { return centers[a] < centers[b]; });
+    QVector<double> newCenters, newStdDevs, newWeights, mass;
+    for (int i : kept) {
+        if (!newCenters.isEmpty()) {
+            const int k = newCenters.size() - 1;
+            const double scale = mergeTolerance * qMin(newStdDevs[k], stdDevs[i]);
+            if (qAbs(centers[i] - newCenters[k]) < scale && qAbs(stdDevs[i] - newStdDevs[k]) < scale) {
+                //|w| weighted mean, plain mean when both weights are zero
+                const double a = mass[k] > 0.0 || qAbs(weights[i]) > 0.0 ? mass[k] : 1.0;
+                const double b = mass[k] > 0.0 || qAbs(weights[i]) > 0.0 ? qAbs(weights[i]) : 1.0;
+                newCenters[k] = (a * newCenters[k] + b * centers[i]) / (a + b);
+                newStdDevs[k] = (a * newStdDevs[k] + b * stdDevs[i]) / (a + b);
+                newWeights[k] += weights[i];
+                mass[k] = a + b;
+                continue;
+            }
+        }
+        newCenters.append(centers[i]);
+        newStdDevs.append(stdDevs[i]);
+        newWeights.append(weights[i]);
+        mass.append(qAbs(weights[i]));
+    }
+
+    centers = newCenters;
+    stdDevs = newStdDevs;
+    weights = newWeights;
+    numNeurons = centers.size();
+
+    //a plain least squares fit of the merged centers overfits the training
+    //grid (large opposite weights), a relative ridge of 1e-2 keeps them smooth
+    RRBFNetwork refitted = *this;
+    if (refitted.solveWeights(data, 1e-2) && refitted.computeError(data) < computeError(data)) {
+        weights = refitted.weights;
+    }
+
+    return originalNeurons - numNeurons;
+}
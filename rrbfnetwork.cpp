@@ -0,0 +1,370 @@
+#include "rrbfnetwork.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtConcurrent>
+#include <QDebug>
+
+RRBFNetwork::RRBFNetwork()
+{
+    numNeurons = 0;
+    seed = 0;
+    basis = GaussianSumBasis;
+}
+
+void RRBFNetwork::initialize(int numNeurons_, quint32 seed_, double stdDevMin, double stdDevMax)
+{
+    //resize vectors
+    numNeurons = numNeurons_;
+    seed = seed_;
+    centers.resize(numNeurons);
+    stdDevs.resize(numNeurons);
+    weights.resize(numNeurons);
+
+    // generate random values
+    // centers : [-3, 3]
+    // stdDevs: [stdDevMin, stdDevMax], default [0.1, 1.0]
+    // weights: [-0.5, 0.5])
+    // rng.generateDouble() generates value between 0 to 1
+
+    auto initBlock = [this, stdDevMin, stdDevMax](int block) {
+        //every block gets its own stream seeded from (seed, block)
+        const quint32 seedBuffer[2] = { seed, static_cast<quint32>(block) };
+        QRandomGenerator rng(seedBuffer);
+
+        int end = qMin(numNeurons, (block + 1) * initBlockSize);
+        for (int i = block * initBlockSize; i < end; ++i) {
+            centers[i] = rng.generateDouble() * 6.0 - 3.0;  // -3 to 3
+            stdDevs[i] = rng.generateDouble() * (stdDevMax - stdDevMin) + stdDevMin; // 0.1 to 1.0 by default
+            weights[i] = rng.generateDouble() - 0.5;        // -0.5 to 0.5
+        }
+    };
+
+    int numBlocks = (numNeurons + initBlockSize - 1) / initBlockSize;
+    if (numBlocks <= 1) {
+        initBlock(0);
+    } else {
+        QVector<int> blocks(numBlocks);
+        for (int b = 0; b < numBlocks; ++b) blocks[b] = b;
+        QtConcurrent::blockingMap(blocks, [&initBlock](int& block) { initBlock(block); });
+    }
+}
+
+namespace {
+
+// the kernel loops, instantiated once per basis function policy (basis.h)
+
+template <class Kernel>
+double outputOf(const RRBFNetwork& network, double x, double y)
+{
+    const double* w = network.weights.constData();
+    const double* m = network.centers.constData();
+    const double* s = network.stdDevs.constData();
+    double output = 0.0;
+    for (int i = 0; i < network.numNeurons; ++i) {
+        output += w[i] * Kernel::phi(x - m[i], y - m[i], 1.0 / (2 * s[i] * s[i]));
+    }
+    return output;
+}
+
+// phi, d phi / d delta and d phi / d m of every neuron, returns the output
+template <class Kernel>
+double derivativesOf(const RRBFNetwork& network, double x, double y, double* phi, double* dStdDevs, double* dCenters)
+{
+    const double* w = network.weights.constData();
+    const double* m = network.centers.constData();
+    const double* s = network.stdDevs.constData();
+    double output = 0.0;
+    for (int i = 0; i < network.numNeurons; ++i) {
+        phi[i] = Kernel::gradients(x - m[i], y - m[i], s[i], dStdDevs[i], dCenters[i]);
+        output += w[i] * phi[i];
+    }
+    return output;
+}
+
+// the same for the neurons sparseGradients() keeps, packed to the front
+template <class Kernel>
+double sparseDerivativesOf(const RRBFNetwork& network, double x, double y, double threshold, int* index,
+                           double* phi, double* dStdDevs, double* dCenters, int& count)
+{
+    const double* w = network.weights.constData();
+    const double* m = network.centers.constData();
+    const double* s = network.stdDevs.constData();
+    const double cutoff = Kernel::cutoff(threshold);
+    double output = 0.0;
+    count = 0;
+    for (int i = 0; i < network.numNeurons; ++i) {
+        if (!Kernel::sparseGradients(x - m[i], y - m[i], s[i], cutoff, phi[count], dStdDevs[count], dCenters[count])) continue;
+        index[count] = i;
+        output += w[i] * phi[count];
+        count++;
+    }
+    return output;
+}
+
+}
+
+double RRBFNetwork::computePhi(int i, double x, double y) const
+{
+    const double dx = x - centers[i];
+    const double dy = y - centers[i];
+    const double k = 1.0 / (2 * stdDevs[i] * stdDevs[i]);
+    switch (basis) {
+    case RadialGaussianBasis: return RadialGaussianKernel::phi(dx, dy, k);
+    case WendlandBasis: return WendlandKernel::phi(dx, dy, k);
+    case InverseMultiquadricBasis: return InverseMultiquadricKernel::phi(dx, dy, k);
+    case GaussianSumBasis: break;
+    }
+    return GaussianSumKernel::phi(dx, dy, k);
+}
+
+double RRBFNetwork::computeOutput(double x, double y) const
+{
+    switch (basis) {
+    case RadialGaussianBasis: return outputOf<RadialGaussianKernel>(*this, x, y);
+    case WendlandBasis: return outputOf<WendlandKernel>(*this, x, y);
+    case InverseMultiquadricBasis: return outputOf<InverseMultiquadricKernel>(*this, x, y);
+    case GaussianSumBasis: break;
+    }
+    return outputOf<GaussianSumKernel>(*this, x, y);
+}
+
+double RRBFNetwork::computeDerivatives(double x, double y, double* phi, double* dStdDevs, double* dCenters) const
+{
+    switch (basis) {
+    case RadialGaussianBasis: return derivativesOf<RadialGaussianKernel>(*this, x, y, phi, dStdDevs, dCenters);
+    case WendlandBasis: return derivativesOf<WendlandKernel>(*this, x, y, phi, dStdDevs, dCenters);
+    case InverseMultiquadricBasis: return derivativesOf<InverseMultiquadricKernel>(*this, x, y, phi, dStdDevs, dCenters);
+    case GaussianSumBasis: break;
+    }
+    return derivativesOf<GaussianSumKernel>(*this, x, y, phi, dStdDevs, dCenters);
+}
+
+double RRBFNetwork::computeGradients(double x, double y, double y_desired, QVector<double>& grad_weights, QVector<double>& grad_stdDevs, QVector<double>& grad_centers) const
+{
+    grad_weights.resize(numNeurons);
+    grad_stdDevs.resize(numNeurons);
+    grad_centers.resize(numNeurons);
+
+    //phi and its derivatives wait in the gradient slots, one kernel evaluation per neuron
+    double y_output = computeDerivatives(x, y, grad_weights.data(), grad_stdDevs.data(), grad_centers.data());
+    double error = y_desired - y_output;
+
+    for (int i = 0; i < numNeurons; ++i) {
+        //gradient for weights (dE/d(w_i))
+        grad_weights[i] = -error * grad_weights[i];
+
+        //gradient for standard deviations (dE/d(delta_i))
+        grad_stdDevs[i] = -error * weights[i] * grad_stdDevs[i];
+
+        //gradient for centers (dE/d(m_i))
+        grad_centers[i] = -error * weights[i] * grad_centers[i];
+    }
+    return error;
+}
+
+void RRBFNetwork::computeSparseGradients(double x, double y, double y_desired, double threshold, QVector<int>& active, QVector<double>& grad_weights, QVector<double>& grad_stdDevs, QVector<double>& grad_centers) const
+{
+    active.resize(numNeurons);
+    grad_weights.resize(numNeurons);
+    grad_stdDevs.resize(numNeurons);
+    grad_centers.resize(numNeurons);
+    int* index = active.data();
+    double* phi = grad_weights.data(); //phi and its derivatives wait in the gradient slots
+    double* dStdDevs = grad_stdDevs.data();
+    double* dCenters = grad_centers.data();
+
+    int count = 0;
+    double y_output = 0.0;
+    switch (basis) {
+    case RadialGaussianBasis:
+        y_output = sparseDerivativesOf<RadialGaussianKernel>(*this, x, y, threshold, index, phi, dStdDevs, dCenters, count);
+        break;
+    case WendlandBasis:
+        y_output = sparseDerivativesOf<WendlandKernel>(*this, x, y, threshold, index, phi, dStdDevs, dCenters, count);
+        break;
+    case InverseMultiquadricBasis:
+        y_output = sparseDerivativesOf<InverseMultiquadricKernel>(*this, x, y, threshold, index, phi, dStdDevs, dCenters, count);
+        break;
+    case GaussianSumBasis:
+        y_output = sparseDerivativesOf<GaussianSumKernel>(*this, x, y, threshold, index, phi, dStdDevs, dCenters, count);
+        break;
+    }
+
+    double error = y_desired - y_output;
+    for (int j = 0; j < count; ++j) {
+        //same terms as computeGradients()
+        int i = index[j];
+        grad_weights[j] = -error * phi[j];
+        grad_stdDevs[j] = -error * weights[i] * dStdDevs[j];
+        grad_centers[j] = -error * weights[i] * dCenters[j];
+    }
+
+    active.resize(count);
+    grad_weights.resize(count);
+    grad_stdDevs.resize(count);
+    grad_centers.resize(count);
+}
+
+double RRBFNetwork::computeJacobianRow(double x, double y, double* row) const
+{
+    //same terms as computeGradients() without the -error factor
+    double* d_weights = row;
+    double* d_stdDevs = row + numNeurons;
+    double* d_centers = row + 2 * numNeurons;
+
+    const double output = computeDerivatives(x, y, d_weights, d_stdDevs, d_centers);
+    for (int i = 0; i < numNeurons; ++i) {
+        d_stdDevs[i] *= weights[i];
+        d_centers[i] *= weights[i];
+    }
+    return output;
+}
+
+void RRBFNetwork::updateParameters(const QVector<double>& grad_weights, const QVector<double>& grad_stdDevs, const QVector<double>& grad_centers, double learningRate)
+{
+    for (int i = 0; i < numNeurons; ++i) {
+        weights[i] -= learningRate * grad_weights[i];
+        stdDevs[i] -= learningRate * grad_stdDevs[i];
+        centers[i] -= learningRate * grad_centers[i];
+
+        //standart deviation must stay positive
+        if (stdDevs[i] < 0.001) stdDevs[i] = 0.001;
+    }
+}
+
+double RRBFNetwork::computeError(const TrainingSet& data) const
+{
+    double totalError = 0.0;
+    for (const auto& sample : data) {
+        double x = sample.first.first;
+        double y = sample.first.second;
+        double y_desired = sample.second;
+        double y_output = computeOutput(x, y);
+        double error = y_desired - y_output;
+        totalError += 0.5 * error * error;  //mean square error
+    }
+    return data.isEmpty() ? 0.0 : totalError / data.size();
+}
+
+bool RRBFNetwork::save(const QString& fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Error: cannot write model file" << fileName;
+        return false;
+    }
+
+    QJsonArray neurons;
+    for (int i = 0; i < numNeurons; ++i) {
+        neurons.append(QJsonArray{ weights[i], centers[i], stdDevs[i] });
+    }
+
+    QJsonObject root;
+    root["format"] = "rrbf-model";
+    root["version"] = 1;
+    root["seed"] = static_cast<qint64>(seed);
+    root["numNeurons"] = numNeurons;
+    root["basis"] = basisName(basis);
+    root["neurons"] = neurons; // [weight, center, stdDev]
+
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+bool RRBFNetwork::load(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Error: cannot read model file" << fileName;
+        return false;
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("format").toString() != "rrbf-model") {
+        qDebug() << "Error:" << fileName << "is not an RRBF model file";
+        return false;
+    }
+
+    QJsonArray neurons = root.value("neurons").toArray();
+    numNeurons = neurons.size();
+    seed = static_cast<quint32>(root.value("seed").toDouble());
+    basis = basisFromName(root.value("basis").toString()); //files without it predate the kernel choice
+    centers.resize(numNeurons);
+    stdDevs.resize(numNeurons);
+    weights.resize(numNeurons);
+    for (int i = 0; i < numNeurons; ++i) {
+        QJsonArray neuron = neurons.at(i).toArray();
+        weights[i] = neuron.at(0).toDouble();
+        centers[i] = neuron.at(1).toDouble();
+        stdDevs[i] = neuron.at(2).toDouble();
+    }
+    return true;
+}
+
+BasisFunction RRBFNetwork::basisFromName(const QString& name, bool* ok)
+{
+    QString lower = name.toLower();
+    if (ok) *ok = true;
+    if (lower == "gaussian") return RadialGaussianBasis;
+    if (lower == "wendland") return WendlandBasis;
+    if (lower == "imq") return InverseMultiquadricBasis;
+    if (ok) *ok = lower == "rrbf";
+    return GaussianSumBasis;
+}
+
+QString RRBFNetwork::basisName(BasisFunction basis)
+{
+    switch (basis) {
+    case RadialGaussianBasis: return "gaussian";
+    case WendlandBasis: return "wendland";
+    case InverseMultiquadricBasis: return "imq";
+    case GaussianSumBasis: break;
+    }
+    return "rrbf";
+}
+
+quint32 RRBFNetwork::randomSeed()
+{
+    //0 is reserved for "pick a random seed", stay in int range so the seed fits the spin box
+    return static_cast<quint32>(QRandomGenerator::global()->bounded(1, 2147483647));
+}
+
+TrainingSet RRBFNetwork::createTrainingDataSet()
+{
+    //create training data for function f = (sin(x)/x)(sin(y)/y)
+    TrainingSet trainingData;
+    for (double x = -3.0; x <= 3.0; x += 0.5) { //13 x 13 = 169 values
+        for (double y = -3.0; y <= 3.0; y += 0.5) {
+
+            double x_val = (x == 0.0) ? 0.00001 : x; //avoid divide by zero for x
+            double y_val = (y == 0.0) ? 0.00001 : y; //avoid divide by zero for y
+
+            double target = (qSin(x_val) / x_val) * (qSin(y_val) / y_val);
+
+            trainingData.push_back({{x, y}, target});
+        }
+    }
+    return trainingData;
+}
+
+TrainingSet RRBFNetwork::createTestDataSet(double stepSize)
+{
+    TrainingSet testData;
+    if (stepSize <= 0.0) return testData;
+    for (double x = -3.0; x <= 3.0; x += stepSize) {
+        for (double y = -3.0; y <= 3.0; y += stepSize) {
+            testData.push_back({{x, y}, targetFunction(x, y)});
+        }
+    }
+    return testData;
+}
+
+double RRBFNetwork::targetFunction(double x, double y)
+{
+    double x_val = (x == 0.0) ? 0.0001 : x;
+    double y_val = (y == 0.0) ? 0.0001 : y;
+    return (qSin(x_val) / x_val) * (qSin(y_val) / y_val);
+}
@@ -0,0 +1,94 @@
+#ifndef RRBFNETWORK_H
+#define RRBFNETWORK_H
+
+#include <QVector>
+#include <QPair>
+#include <QString>
+#include <QtMath>
+#include <QRandomGenerator>
+
+#include "basis.h"
+
+// ((x, y), Z) samples used for training and testing
+typedef QVector<QPair<QPair<double, double>, double>> TrainingSet;
+
+// RRBF network parameters and kernels, free of any GUI code so that the
+// training loop can also run headless from the command line
+class RRBFNetwork
+{
+public:
+    RRBFNetwork();
+
+    QVector<double> centers; // m_i
+    QVector<double> stdDevs; // delta_i
+    QVector<double> weights; // w_i
+    int numNeurons;
+    quint32 seed;            // seed used by the last initialize() call
+    BasisFunction basis;     // kernel of every neuron, see basis.h
+
+    // neurons are initialized in blocks of this size, every block has its own
+    // random stream derived from (seed, block index), so the result does not
+    // depend on how many threads take part in the initialization
+    static const int initBlockSize = 256;
+
+    // stdDevs are drawn from [stdDevMin, stdDevMax]
+    void initialize(int numNeurons_, quint32 seed_, double stdDevMin = 0.1, double stdDevMax = 1.0);
+    // centers from k-means++ / Lloyd on the data coordinates, stdDevs from
+    // the nearest neighbouring center (kmeans.cpp)
+    void initializeKMeans(int numNeurons_, quint32 seed_, const TrainingSet& data,
+                          int maxIterations = 50, double sigmaScale = 1.0);
+    // sets the weights to the (ridge regularized) least squares solution for
+    // the current centers and stdDevs (leastsquares.cpp); false and the
+    // weights unchanged if the system stays singular
+    bool solveWeights(const TrainingSet& data, double ridge = 1e-8);
+    // drops the neurons whose RMS contribution w_i phi_i on data is below
+    // pruneTolerance, merges neurons whose centers and stdDevs differ by less
+    // than mergeTolerance times the smaller stdDev, then re-fits the weights
+    // by ridge regression if that helps; returns the neurons removed (pruning.cpp)
+    int compress(const TrainingSet& data, double pruneTolerance, double mergeTolerance);
+    // appends one neuron (growing.cpp)
+    void addNeuron(double center, double stdDev, double weight);
+    double computePhi(int i, double x, double y) const;
+    double computeOutput(double x, double y) const;
+    // phi_i, d phi_i / d delta_i and d phi_i / d m_i of every neuron into
+    // arrays of numNeurons, returns the output
+    double computeDerivatives(double x, double y, double* phi, double* dStdDevs, double* dCenters) const;
+    // returns the residual y_desired - output at (x, y)
+    double computeGradients(double x, double y, double y_desired,
+                            QVector<double>& grad_weights,
+                            QVector<double>& grad_stdDevs,
+                            QVector<double>& grad_centers) const;
+    // only the neurons with phi_x or phi_y (the kernel value for the radial
+    // bases) above threshold: their indices go to active and their gradients,
+    // in the same order, to the front of the grad_ vectors. Terms below the
+    // threshold count as zero, also in the output, and are never passed to
+    // qExp. The Wendland basis ignores the threshold and keeps exactly the
+    // neurons whose support contains the input.
+    void computeSparseGradients(double x, double y, double y_desired, double threshold,
+                                QVector<int>& active,
+                                QVector<double>& grad_weights,
+                                QVector<double>& grad_stdDevs,
+                                QVector<double>& grad_centers) const;
+    // d(output)/d(parameter) for one input, row layout [w_0..w_n-1, delta_0..., m_0...];
+    // returns the output
+    double computeJacobianRow(double x, double y, double* row) const;
+    void updateParameters(const QVector<double>& grad_weights,
+                          const QVector<double>& grad_stdDevs,
+                          const QVector<double>& grad_centers,
+                          double learningRate);
+    double computeError(const TrainingSet& data) const;
+
+    bool save(const QString& fileName) const;
+    bool load(const QString& fileName);
+
+    // rrbf, gaussian, wendland or imq; other names give rrbf and *ok = false
+    static BasisFunction basisFromName(const QString& name, bool* ok = nullptr);
+    static QString basisName(BasisFunction basis);
+    static quint32 randomSeed();
+    static TrainingSet createTrainingDataSet();
+    // the x, y grid from -3 to 3 that drawTestGraph() evaluates, empty for stepSize <= 0
+    static TrainingSet createTestDataSet(double stepSize);
+    static double targetFunction(double x, double y);
+};
+
+#endif // RRBFNETWORK_H
@@ -0,0 +1,301 @@
+#include "rrbftrainer.h"
+#include "profiler.h"
+
+#include <limits>
+
+RRBFTrainer::RRBFTrainer(RRBFNetwork& network_, const TrainingSet& allData_)
+    : network(network_)
+    , allData(allData_)
+{
+    dataIndex = 0;
+    epochCounter = 0;
+    stepCounter = 0;
+    totalError = 0.0;
+    bestError = 0.0;
+    lmDamping = 1e-3;
+    activeFraction = 1.0;
+    neuronsAdded = 0;
+    failedSolves = 0;
+    rejectedSteps = 0;
+    growCheckError = 0.0;
+    activeSum = 0;
+    activeSamples = 0;
+    validationError = 0.0;
+    bestValidationError = 0.0;
+    bestValidationStep = 0;
+    earlyStopped = false;
+    evaluationsSinceBest = 0;
+}
+
+void RRBFTrainer::start(const TrainingOptions& options_)
+{
+    options = options_;
+    if (options.seed == 0) options.seed = RRBFNetwork::randomSeed();
+    splitData();
+
+    network.basis = options.basis;
+    if (options.initMethod == TrainingOptions::InitKMeans) {
+        network.initializeKMeans(options.numNeurons, options.seed, trainingData);
+    } else {
+        network.initialize(options.numNeurons, options.seed, options.initStdDevMin, options.initStdDevMax);
+    }
+    failedSolves = 0;
+    if (options.solveWeights && !network.solveWeights(trainingData)) failedSolves++;
+    if (options.prioritySampling > 0.0) {
+        const quint32 seedBuffer[2] = { options.seed, 0x9a17u };
+        sampleRng = QRandomGenerator(seedBuffer);
+        resetPriorities();
+    }
+
+    optimizer.momentum = options.momentum;
+    optimizer.weightsRateScale = options.weightsRateScale;
+    optimizer.stdDevsRateScale = options.stdDevsRateScale;
+    optimizer.centersRateScale = options.centersRateScale;
+    optimizer.reset(options.optimizer, network.numNeurons);
+
+    schedule.period = options.schedulePeriod;
+    schedule.gamma = options.scheduleGamma;
+    schedule.minRate = options.minLearningRate;
+    schedule.cycleMultiplier = options.restartMultiplier;
+    schedule.reset(options.schedule, options.learningRate);
+
+    dataIndex = 0;
+    epochCounter = 0;
+    stepCounter = 0;
+    totalError = 0.0;
+    bestError = std::numeric_limits<double>::infinity();
+    lmDamping = 1e-3;
+    rejectedSteps = 0;
+    grad_weights.clear();
+    grad_stdDevs.clear();
+    grad_centers.clear();
+    touched.clear();
+    isTouched.fill(false, network.numNeurons);
+    batch_weights.fill(0.0, network.numNeurons);
+    batch_stdDevs.fill(0.0, network.numNeurons);
+    batch_centers.fill(0.0, network.numNeurons);
+    activeFraction = 1.0;
+    activeSum = 0;
+    activeSamples = 0;
+    neuronsAdded = 0;
+    growCheckError = std::numeric_limits<double>::infinity();
+    validationError = 0.0;
+    bestValidationError = std::numeric_limits<double>::infinity();
+    bestValidationStep = 0;
+    earlyStopped = false;
+    evaluationsSinceBest = 0;
+    if (options.perfCounters && gradientPerf.open()) forwardPerf.open();
+    timer.start();
+}
+
+double RRBFTrainer::trainStep()
+{
+    if (options.levenbergMarquardt) {
+        RRBF_PROFILE_SCOPE(PhaseSolve);
+        if (!levenbergMarquardtStep(totalError)) rejectedSteps++;
+        bestError = qMin(bestError, totalError);
+        stepCounter++;
+        epochCounter++;
+        if (options.growMaxNeurons > 0) growNetwork();
+        evaluateValidation();
+        return totalError;
+    }
+
+    //totalError is still the error before this step
+    const double learningRate = schedule.rate(stepCounter, totalError);
+
+    if (usesSparseGradients()) {
+        sparseGradientStep(learningRate);
+    } else {
+        //mini-batch: average the gradients of batchSize consecutive samples
+        const int batchSize = qMax(1, options.batchSize);
+        for (int b = 0; b < batchSize; ++b) {
+            int index = dataIndex;
+            double importance = 1.0;
+            if (options.prioritySampling > 0.0) index = drawSample(importance);
+            const auto& data = trainingData[index];
+            double x = data.first.first;
+            double y = data.first.second;
+            double y_desired = data.second;
+
+            double residual;
+            {
+                RRBF_PROFILE_SCOPE(PhaseGradient);
+                if (options.perfCounters) gradientPerf.start();
+                residual = network.computeGradients(x, y, y_desired, grad_weights, grad_stdDevs, grad_centers);
+                if (options.perfCounters) gradientPerf.stop();
+            }
+            if (options.prioritySampling > 0.0) prioritizeSample(index, residual, importance);
+            if (batchSize > 1) {
+                if (b == 0) {
+                    batch_weights = grad_weights;
+                    batch_stdDevs = grad_stdDevs;
+                    batch_centers = grad_centers;
+                } else {
+                    for (int i = 0; i < network.numNeurons; ++i) {
+                        batch_weights[i] += grad_weights[i];
+                        batch_stdDevs[i] += grad_stdDevs[i];
+                        batch_centers[i] += grad_centers[i];
+                    }
+                }
+            }
+
+            dataIndex = (dataIndex + 1) % trainingData.size();
+            //an epoch is trainingData.size() samples, drawn or in order
+            if (dataIndex == 0) {
+                epochCounter++;
+                if (options.prioritySampling > 0.0) resetPriorities();
+            }
+        }
+
+        {
+            RRBF_PROFILE_SCOPE(PhaseUpdate);
+            if (batchSize > 1) {
+                for (int i = 0; i < network.numNeurons; ++i) {
+                    batch_weights[i] /= batchSize;
+                    batch_stdDevs[i] /= batchSize;
+                    batch_centers[i] /= batchSize;
+                }
+                optimizer.step(network, batch_weights, batch_stdDevs, batch_centers, learningRate);
+            } else {
+                optimizer.step(network, grad_weights, grad_stdDevs, grad_centers, learningRate);
+            }
+        }
+    }
+    stepCounter++;
+
+    //alternate SGD on centers/stdDevs with an exact solve for the weights
+    if (options.solveWeightsInterval > 0 && stepCounter % options.solveWeightsInterval == 0) {
+        RRBF_PROFILE_SCOPE(PhaseSolve);
+        if (!network.solveWeights(trainingData)) failedSolves++;
+    }
+
+    RRBF_PROFILE_SCOPE(PhaseError);
+    if (options.perfCounters) forwardPerf.start();
+    totalError = network.computeError(trainingData);
+    if (options.perfCounters) forwardPerf.stop();
+    bestError = qMin(bestError, totalError);
+    if (options.growMaxNeurons > 0) growNetwork();
+    evaluateValidation();
+    return totalError;
+}
+
+void RRBFTrainer::splitData()
+{
+    trainingData = allData;
+    validationData.clear();
+
+    //at least one sample is left to train on
+    int validationSize = qBound(0, qRound(options.validationFraction * allData.size()), allData.size() - 1);
+    if (validationSize == 0) return;
+
+    //the split follows the seed, the training samples keep their order
+    const quint32 seedBuffer[2] = { options.seed, 0x5b117u };
+    QRandomGenerator rng(seedBuffer);
+    QVector<int> order(allData.size());
+    for (int i = 0; i < order.size(); ++i) order[i] = i;
+    for (int i = order.size() - 1; i > 0; --i) qSwap(order[i], order[rng.bounded(i + 1)]);
+
+    QVector<bool> heldOut(allData.size(), false);
+    for (int i = 0; i < validationSize; ++i) heldOut[order[i]] = true;
+
+    trainingData.clear();
+    for (int i = 0; i < allData.size(); ++i) {
+        if (heldOut[i]) validationData.append(allData[i]);
+        else trainingData.append(allData[i]);
+    }
+}
+
+void RRBFTrainer::evaluateValidation()
+{
+    if (validationData.isEmpty()) return;
+
+    const bool stepLimit = options.maxSteps > 0 && stepCounter >= options.maxSteps;
+    if (stepCounter % qMax(1, options.validationInterval) != 0 && !stepLimit) return;
+
+    validationError = network.computeError(validationData);
+    if (validationError < bestValidationError - options.minDelta) {
+        bestValidationError = validationError;
+        bestValidationStep = stepCounter;
+        evaluationsSinceBest = 0;
+        if (options.restoreBest) bestNetwork = network;
+    } else {
+        evaluationsSinceBest++;
+        if (options.patience > 0 && evaluationsSinceBest >= options.patience) earlyStopped = true;
+    }
+
+    //go back to the best model when the run ends without reaching the stop condition
+    if ((earlyStopped || stepLimit) && options.restoreBest && bestValidationStep > 0
+            && bestValidationStep != stepCounter) {
+        network = bestNetwork;
+        validationError = bestValidationError;
+        totalError = network.computeError(trainingData);
+    }
+}
+
+bool RRBFTrainer::isFinished() const
+{
+    if (earlyStopped) return true;
+    if (stepCounter > 0 && totalError < options.stopCondition) return true;
+    return options.maxSteps > 0 && stepCounter >= options.maxSteps;
+}
+
+qint64 RRBFTrainer::elapsedMs() const
+{
+    return timer.elapsed();
+}
+
+void RRBFTrainer::gradientNorms(double& weights, double& stdDevs, double& centers) const
+{
+    weights = stdDevs = centers = 0.0;
+    if (options.levenbergMarquardt || grad_weights.isEmpty()) return;
+
+    //the batch_* vectors hold the averaged gradient after a mini-batch or sparse step
+    const bool batched = options.batchSize > 1 || usesSparseGradients();
+    const QVector<double>& gw = batched ? batch_weights : grad_weights;
+    const QVector<double>& gs = batched ? batch_stdDevs : grad_stdDevs;
+    const QVector<double>& gc = batched ? batch_centers : grad_centers;
+    for (int i = 0; i < gw.size(); ++i) {
+        weights += gw[i] * gw[i];
+        stdDevs += gs[i] * gs[i];
+        centers += gc[i] * gc[i];
+    }
+    weights = qSqrt(weights);
+    stdDevs = qSqrt(stdDevs);
+    centers = qSqrt(centers);
+}
+
+int RRBFTrainer::samplesPerStep() const
+{
+    return options.levenbergMarquardt ? trainingData.size() : qMax(1, options.batchSize);
+}
+
+bool RRBFTrainer::usesSparseGradients() const
+{
+    return options.sparseThreshold > 0.0 && options.optimizer == RRBFOptimizer::SGD;
+}
+
+double RRBFTrainer::learningRate() const
+{
+    return schedule.currentRate();
+}
+
+bool RRBFTrainer::perfCountersAvailable() const
+{
+    return gradientPerf.isOpen() && forwardPerf.isOpen();
+}
+
+QString RRBFTrainer::perfCountersError() const
+{
+    return gradientPerf.isOpen() ? forwardPerf.errorString() : gradientPerf.errorString();
+}
+
+PerfCounterValues RRBFTrainer::gradientCounters() const
+{
+    return gradientPerf.read();
+}
+
+PerfCounterValues RRBFTrainer::forwardCounters() const
+{
+    return forwardPerf.read();
+}
@@ -0,0 +1,129 @@
+#ifndef RRBFTRAINER_H
+#define RRBFTRAINER_H
+
+#include "rrbfnetwork.h"
+#include "optimizer.h"
+#include "schedule.h"
+#include "perfcounters.h"
+#include "sumtree.h"
+
+#include <QElapsedTimer>
+
+// settings of one training run, filled from the GUI or the command line
+struct TrainingOptions
+{
+    enum InitMethod { InitRandom, InitKMeans };
+
+    int numNeurons = 16;
+    double learningRate = 0.002;
+    int batchSize = 1;                  // samples averaged per gradient step
+    double stopCondition = 0.001;
+    quint32 seed = 0;       // 0 = pick a random seed
+    InitMethod initMethod = InitRandom;
+    BasisFunction basis = GaussianSumBasis;
+    double initStdDevMin = 0.1;         // random init: stdDevs drawn from [min, max]
+    double initStdDevMax = 1.0;
+    bool solveWeights = false;          // least squares weights after initialization
+    int solveWeightsInterval = 0;       // re-solve the weights every N steps, 0 = never
+    RRBFOptimizer::Type optimizer = RRBFOptimizer::SGD;
+    double momentum = 0.9;              // Momentum/Nesterov coefficient, Adam beta1
+    LearningRateSchedule::Type schedule = LearningRateSchedule::Constant;
+    int schedulePeriod = 1000;          // see LearningRateSchedule::period
+    double scheduleGamma = 0.5;
+    double minLearningRate = 0.0;
+    double restartMultiplier = 2.0;     // cosine cycle growth
+    double weightsRateScale = 1.0;      // learning rate factors per parameter group
+    double stdDevsRateScale = 1.0;
+    double centersRateScale = 1.0;
+    bool levenbergMarquardt = false;    // batch LM iterations instead of per-sample steps
+    double sparseThreshold = 0.0;       // SGD only: skip neurons with phi_x, phi_y below this, 0 = dense
+    double prioritySampling = 0.0;      // dense steps: draw samples by |residual|^this, 0 = in order
+    double priorityCorrection = 1.0;    // importance weight exponent, 1 = unbiased, 0 = none
+    // growing network: start with numNeurons and add neurons up to growMaxNeurons
+    int growMaxNeurons = 0;             // 0 = fixed size
+    int growInterval = 0;               // steps between two progress checks, 0 = one epoch
+    double growThreshold = 0.01;        // add a neuron when the error fell by less than this share
+    qint64 maxSteps = 0;    // 0 = no limit (headless runs only)
+    bool perfCounters = false;          // count cycles/misses in the SGD gradient and error kernels
+    // early stopping on a held-out part of the data set
+    double validationFraction = 0.0;    // share of the samples held out, 0 = no validation split
+    int validationInterval = 100;       // evaluate the validation error every N steps
+    int patience = 10;                  // stop after N evaluations without improvement, 0 = never
+    double minDelta = 0.0;              // smaller improvements do not count
+    bool restoreBest = true;            // end with the parameters of the best validation error
+};
+
+// online (per-sample or mini-batch) gradient descent on an RRBFNetwork,
+// or one Levenberg-Marquardt iteration over the whole data set per step
+class RRBFTrainer
+{
+public:
+    RRBFTrainer(RRBFNetwork& network_, const TrainingSet& allData_);
+
+    void start(const TrainingOptions& options_);
+    double trainStep();
+    bool isFinished() const;
+    qint64 elapsedMs() const;
+
+    // hardware counters of the run so far, zero unless options.perfCounters
+    // is set and perfCountersAvailable()
+    bool perfCountersAvailable() const;
+    QString perfCountersError() const;
+    PerfCounterValues gradientCounters() const;
+    PerfCounterValues forwardCounters() const;
+
+    // L2 norms of the gradient applied by the last SGD step (batch mean),
+    // zero before the first step and in Levenberg-Marquardt mode
+    void gradientNorms(double& weights, double& stdDevs, double& centers) const;
+    int samplesPerStep() const;
+    double learningRate() const; // of the last step, after the schedule
+    bool usesSparseGradients() const; // options.sparseThreshold > 0 with plain SGD
+
+    TrainingOptions options;
+    int dataIndex;          // Eğitim döngüsünde hangi veri noktasının işlendiğini takip eder
+    int epochCounter;
+    qint64 stepCounter;
+    double totalError;
+    double bestError;       // lowest totalError since start()
+    double lmDamping;
+    double activeFraction;  // share of the neurons a sparse step touched, mean over the last epoch
+    int neuronsAdded;       // by the growing network since start()
+    int failedSolves;       // least squares weight solves that kept the previous weights
+    int rejectedSteps;      // Levenberg-Marquardt iterations without an improving step
+
+    TrainingSet trainingData;   // the samples trained on, all samples without a validation split
+    TrainingSet validationData;
+    double validationError;     // at the last evaluation
+    double bestValidationError;
+    qint64 bestValidationStep;
+    bool earlyStopped;
+
+private:
+    bool levenbergMarquardtStep(double& error); // levenbergmarquardt.cpp
+    void sparseGradientStep(double learningRate); // sparse.cpp
+    void growNetwork(); // growing.cpp
+    void resetPriorities(); // prioritized.cpp
+    int drawSample(double& importance);
+    void prioritizeSample(int index, double residual, double importance);
+    void splitData();
+    void evaluateValidation();
+
+    RRBFNetwork& network;
+    const TrainingSet& allData;
+    RRBFNetwork bestNetwork;
+    int evaluationsSinceBest;
+    double growCheckError;  // training error at the last growth check
+    QVector<double> grad_weights, grad_stdDevs, grad_centers;
+    QVector<double> batch_weights, batch_stdDevs, batch_centers;
+    QVector<int> active, touched;   // sparse steps: neurons of the sample / of the whole batch
+    QVector<bool> isTouched;
+    qint64 activeSum, activeSamples;
+    SumTree priorities;     // of the training samples, prioritized sampling only
+    QRandomGenerator sampleRng;
+    RRBFOptimizer optimizer;
+    LearningRateSchedule schedule;
+    QElapsedTimer timer;
+    PerfCounters gradientPerf, forwardPerf;
+};
+
+#endif // RRBFTRAINER_H
@@ -0,0 +1,97 @@
+#include "schedule.h"
+
+#include <QtMath>
+#include <limits>
+
+LearningRateSchedule::LearningRateSchedule()
+{
+    type = Constant;
+    baseRate = 0.002;
+    period = 1000;
+    gamma = 0.5;
+    minRate = 0.0;
+    cycleMultiplier = 2.0;
+    threshold = 1e-3;
+    reset(Constant, baseRate);
+}
+
+void LearningRateSchedule::reset(Type type_, double baseRate_)
+{
+    type = type_;
+    baseRate = baseRate_;
+    current = baseRate;
+    cycleStart = 0;
+    cycleLength = qMax(1, period);
+    bestError = std::numeric_limits<double>::infinity();
+    stepsSinceBest = 0;
+}
+
+double LearningRateSchedule::rate(qint64 step, double error)
+{
+    const int steps = qMax(1, period);
+
+    switch (type) {
+    case Constant:
+        current = baseRate;
+        break;
+    case StepDecay:
+        current = baseRate * qPow(gamma, double(step / steps));
+        break;
+    case Exponential:
+        current = baseRate * qPow(gamma, double(step) / steps);
+        break;
+    case CosineRestarts: {
+        //SGDR: anneal from baseRate to minRate, then jump back up
+        while (step - cycleStart >= cycleLength) {
+            cycleStart += cycleLength;
+            cycleLength = qMax(qint64(1), qRound64(cycleLength * cycleMultiplier));
+        }
+        double progress = double(step - cycleStart) / cycleLength;
+        current = minRate + 0.5 * (baseRate - minRate) * (1.0 + qCos(M_PI * progress));
+        break;
+    }
+    case Plateau:
+        //no error is known before the first step
+        if (step == 0) break;
+        if (error < bestError * (1.0 - threshold)) {
+            bestError = error;
+            stepsSinceBest = 0;
+        } else if (++stepsSinceBest >= steps) {
+            current *= gamma;
+            stepsSinceBest = 0;
+        }
+        break;
+    }
+
+    current = qMax(current, minRate);
+    return current;
+}
+
+double LearningRateSchedule::currentRate() const
+{
+    return current;
+}
+
+LearningRateSchedule::Type LearningRateSchedule::typeFromName(const QString& name, bool* ok)
+{
+    QString lower = name.toLower();
+    if (ok) *ok = true;
+    if (lower == "step") return StepDecay;
+    if (lower == "exp" || lower == "exponential") return Exponential;
+    if (lower == "cosine") return CosineRestarts;
+    if (lower == "plateau") return Plateau;
+    if (ok) *ok = lower == "constant";
+    return Constant;
+}
+
+QString LearningRateSchedule::typeName(Type type)
+{
+    switch (type) {
+    case StepDecay: return "step";
+    case Exponential: return "exp";
+    case CosineRestarts: return "cosine";
+    case Plateau: return "plateau";
+    case Constant: break;
+    }
+    return "constant";
+}
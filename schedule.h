@@ -0,0 +1,39 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <QString>
+
+// learning rate as a function of the training step. rate() is called once
+// per step with the error of the previous step, which only the plateau
+// schedule looks at.
+class LearningRateSchedule
+{
+public:
+    enum Type { Constant, StepDecay, Exponential, CosineRestarts, Plateau };
+
+    LearningRateSchedule();
+
+    Type type;
+    double baseRate;
+    int period;             // steps per decay, first cosine cycle, plateau patience
+    double gamma;           // decay factor of StepDecay, Exponential and Plateau
+    double minRate;         // lower bound, the bottom of the cosine cycles
+    double cycleMultiplier; // cosine cycle i lasts period * cycleMultiplier^i steps
+    double threshold;       // relative error decrease that counts as progress on a plateau
+
+    void reset(Type type_, double baseRate_);
+    double rate(qint64 step, double error);
+    double currentRate() const;
+
+    // other names than constant, step, exp, cosine or plateau give Constant and *ok = false
+    static Type typeFromName(const QString& name, bool* ok = nullptr);
+    static QString typeName(Type type);
+
+private:
+    double current;
+    qint64 cycleStart, cycleLength;
+    double bestError;
+    qint64 stepsSinceBest;
+};
+
+#endif // SCHEDULE_H
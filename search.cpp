@@ -0,0 +1,327 @@
+#include "search.h"
+#include "commandline.h"
+#include "rrbftrainer.h"
+#include "threadpool.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// values of one hyperparameter: a list to pick from, or a "min:max" range
+struct Choice
+{
+    QStringList values;
+    bool isRange;
+    double low, high;
+
+    Choice(const QCommandLineParser& parser, const QString& name, const QString& defaultValue)
+    {
+        values = (parser.isSet(name) ? parser.value(name) : defaultValue).split(',', Qt::SkipEmptyParts);
+        QStringList range = values.size() == 1 ? values[0].split(':') : QStringList();
+        isRange = range.size() == 2 && name != "init-sigma"; //init-sigma values are ranges themselves
+        low = isRange ? range[0].toDouble() : 0.0;
+        high = isRange ? range[1].toDouble() : 0.0;
+        if (isRange) values = range; //a grid takes the two ends
+    }
+};
+
+struct Trial
+{
+    int id;
+    int bracket;
+    TrainingOptions options;
+    RRBFNetwork network;
+    std::unique_ptr<RRBFTrainer> trainer;
+    qint64 timeMs;          // summed over the rungs
+    int rung;               // last rung trained
+    bool killed;
+    double testError;
+};
+
+// successive halving: rung k trains the surviving trials of the bracket to
+// rungSteps(k) steps, then only the best 1/eta of them go on
+struct Bracket
+{
+    int index;
+    int rungs;              // the last rung trains to the full budget
+    qint64 minSteps;        // steps of rung 0
+    int rung;
+    QVector<Trial*> alive;
+    std::atomic<int> remaining; // trials of the current rung still training
+};
+
+struct Search
+{
+    const TrainingSet* trainingData;
+    WorkStealingPool* pool;
+    qint64 budget;
+    double eta;
+    std::mutex outputMutex;
+    QTextStream* out;
+
+    qint64 rungSteps(const Bracket& bracket, int rung) const
+    {
+        if (rung >= bracket.rungs - 1) return budget;
+        return qMax<qint64>(1, qRound64(bracket.minSteps * qPow(eta, rung)));
+    }
+};
+
+bool reached(const Trial& trial)
+{
+    return trial.trainer && trial.trainer->stepCounter > 0
+           && trial.trainer->totalError < trial.options.stopCondition;
+}
+
+// runs that reached the stop condition first (fewest steps), then the
+// lowest training error as computed by trainStep()
+bool isBetter(const Trial* a, const Trial* b)
+{
+    const bool aReached = reached(*a);
+    const bool bReached = reached(*b);
+    if (aReached != bReached) return aReached;
+    if (aReached) return a->trainer->stepCounter < b->trainer->stepCounter;
+    return a->trainer->totalError < b->trainer->totalError;
+}
+
+void submitRung(Search& search, Bracket& bracket);
+
+// after the last trial of a rung: keep the best, kill the rest, go on
+void promote(Search& search, Bracket& bracket)
+{
+    QVector<Trial*>& alive = bracket.alive;
+    std::stable_sort(alive.begin(), alive.end(), isBetter);
+
+    const bool lastRung = bracket.rung >= bracket.rungs - 1;
+    const int keep = lastRung ? alive.size() : qMax(1, static_cast<int>(alive.size() / search.eta));
+    {
+        std::lock_guard<std::mutex> lock(search.outputMutex);
+        *search.out << QString("bracket %1, rung %2: %3 runs at %4 steps, best error %5%6").arg(bracket.index)
+                       .arg(bracket.rung).arg(alive.size()).arg(search.rungSteps(bracket, bracket.rung))
+                       .arg(alive.first()->trainer->totalError, 0, 'f', 6)
+                       .arg(lastRung ? QString() : QString(", %1 continue").arg(keep)) << Qt::endl;
+    }
+    if (lastRung) return;
+
+    for (int t = keep; t < alive.size(); ++t) alive[t]->killed = true;
+    alive.resize(keep);
+    bracket.rung++;
+    submitRung(search, bracket);
+}
+
+void submitRung(Search& search, Bracket& bracket)
+{
+    const qint64 steps = search.rungSteps(bracket, bracket.rung);
+    bracket.remaining = bracket.alive.size();
+    for (Trial* trial : bracket.alive) {
+        //submitted from a worker, the next rung stays on its deque unless stolen
+        search.pool->submit([&search, &bracket, trial, steps]() {
+            QElapsedTimer timer;
+            timer.start();
+            if (!trial->trainer) {
+                trial->trainer.reset(new RRBFTrainer(trial->network, *search.trainingData));
+                trial->trainer->start(trial->options);
+            }
+            RRBFTrainer& trainer = *trial->trainer;
+            while (!trainer.isFinished() && trainer.stepCounter < steps) trainer.trainStep();
+            trial->timeMs += timer.elapsed();
+            trial->rung = bracket.rung;
+
+            if (--bracket.remaining == 0) promote(search, bracket);
+        });
+    }
+}
+
+}
+
+void addSearchOptions(QCommandLineParser& parser)
+{
+    parser.addOptions({
+        {"search", "Hyperparameter search over --neurons, --learning-rate, --init-sigma and --optimizer: grid or random.", "strategy"},
+        {"search-schedule", "full, halving (successive halving, default) or hyperband.", "name"},
+        {"search-trials", "Random configurations to try (default 27, Hyperband: per bracket as needed).", "n"},
+        {"search-eta", "Only the best 1/eta of the runs continue after a rung (default 3).", "eta"},
+        {"search-min-steps", "Steps of the shortest rung (default one epoch).", "steps"},
+        {"search-threads", "Worker threads of the search (default one per core).", "n"},
+        {"leaderboard", "Rows of the search leaderboard (default 10).", "n"},
+    });
+}
+
+int runSearch(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+
+    const QString strategy = parser.value("search");
+    const QString schedule = parser.isSet("search-schedule") ? parser.value("search-schedule") : "halving";
+    if ((strategy != "grid" && strategy != "random") || (schedule != "full" && schedule != "halving" && schedule != "hyperband")) {
+        out << "error: --search takes grid or random, --search-schedule full, halving or hyperband" << Qt::endl;
+        return 1;
+    }
+
+    //the single valued options (stop condition, init, seed, ...) are shared by all runs
+    TrainingOptions base = trainingOptionsFromParser(parser, TrainingOptions());
+    if (!parser.isSet("max-steps")) base.maxSteps = 16900; //100 epochs
+    if (base.seed == 0) base.seed = 1; //the same initial parameters for every configuration
+    const double eta = qMax(2.0, parser.isSet("search-eta") ? parser.value("search-eta").toDouble() : 3.0);
+    const int trials = qMax(1, parser.isSet("search-trials") ? parser.value("search-trials").toInt() : 27);
+    const int leaderboard = parser.isSet("leaderboard") ? parser.value("leaderboard").toInt() : 10;
+
+    const Choice neurons(parser, "neurons", "8,16,32,64");
+    const Choice learningRates(parser, "learning-rate", "0.001,0.002,0.005,0.01");
+    const Choice sigmas(parser, "init-sigma", "0.1:1");
+    const Choice optimizers(parser, "optimizer", "sgd,adam");
+
+    const TrainingSet trainingData = RRBFNetwork::createTrainingDataSet();
+    const double testStep = parser.isSet("test-step") ? parser.value("test-step").toDouble() : 0.1;
+    const TrainingSet testData = RRBFNetwork::createTestDataSet(testStep);
+    const qint64 minSteps = qMax<qint64>(1, parser.isSet("search-min-steps") ? parser.value("search-min-steps").toLongLong()
+                                                                             : trainingData.size());
+
+    //every grid point, shuffled so that Hyperband brackets see a spread of them
+    QVector<TrainingOptions> grid;
+    for (const QString& n : neurons.values) {
+        for (const QString& rate : learningRates.values) {
+            for (const QString& sigma : sigmas.values) {
+                for (const QString& optimizer : optimizers.values) {
+                    TrainingOptions options = base;
+                    options.numNeurons = n.toInt();
+                    options.learningRate = rate.toDouble();
+                    QStringList range = sigma.split(':');
+                    options.initStdDevMin = range.value(0).toDouble();
+                    options.initStdDevMax = range.value(1, range.value(0)).toDouble();
+                    options.optimizer = RRBFOptimizer::typeFromName(optimizer);
+                    grid.append(options);
+                }
+            }
+        }
+    }
+    const quint32 seedBuffer[2] = { base.seed, 0x5ea4c4u };
+    QRandomGenerator rng(seedBuffer);
+    for (int i = grid.size() - 1; i > 0; --i) qSwap(grid[i], grid[rng.bounded(i + 1)]);
+
+    auto pick = [&rng](const Choice& choice) { return choice.values[rng.bounded(choice.values.size())]; };
+    int nextGridPoint = 0;
+    auto candidate = [&]() -> TrainingOptions {
+        if (strategy == "grid") return grid[nextGridPoint++ % grid.size()];
+        TrainingOptions options = base;
+        //neurons uniform, learning rate log-uniform within a range
+        options.numNeurons = neurons.isRange ? qRound(neurons.low + rng.generateDouble() * (neurons.high - neurons.low))
+                                             : pick(neurons).toInt();
+        options.learningRate = learningRates.isRange
+                ? learningRates.low * qPow(learningRates.high / learningRates.low, rng.generateDouble())
+                : pick(learningRates).toDouble();
+        QStringList range = pick(sigmas).split(':');
+        options.initStdDevMin = range.value(0).toDouble();
+        options.initStdDevMax = range.value(1, range.value(0)).toDouble();
+        options.optimizer = RRBFOptimizer::typeFromName(pick(optimizers));
+        return options;
+    };
+
+    //brackets (n runs, rungs): full = (N, 1), halving = (N, sMax + 1),
+    //hyperband = (ceil((sMax + 1) / (s + 1) * eta^s), s + 1) for s = sMax .. 0
+    const int sMax = qMax(0, static_cast<int>(qFloor(qLn(double(base.maxSteps) / minSteps) / qLn(eta) + 1e-9)));
+    const int candidates = strategy == "grid" ? grid.size() : trials;
+    QVector<QPair<int, int>> shapes;
+    if (schedule == "full") shapes.append(qMakePair(candidates, 1));
+    else if (schedule == "halving") shapes.append(qMakePair(candidates, sMax + 1));
+    else for (int s = sMax; s >= 0; --s) shapes.append(qMakePair(qCeil((sMax + 1.0) / (s + 1) * qPow(eta, s)), s + 1));
+
+    std::vector<std::unique_ptr<Trial>> allTrials;
+    std::vector<std::unique_ptr<Bracket>> brackets;
+    for (int b = 0; b < shapes.size(); ++b) {
+        std::unique_ptr<Bracket> bracket(new Bracket);
+        bracket->index = b;
+        bracket->rungs = shapes[b].second;
+        bracket->minSteps = qMax<qint64>(1, qRound64(base.maxSteps / qPow(eta, bracket->rungs - 1)));
+        bracket->rung = 0;
+        for (int t = 0; t < shapes[b].first; ++t) {
+            std::unique_ptr<Trial> trial(new Trial);
+            trial->id = static_cast<int>(allTrials.size());
+            trial->bracket = b;
+            trial->options = candidate();
+            trial->timeMs = 0;
+            trial->rung = 0;
+            trial->killed = false;
+            trial->testError = 0.0;
+            bracket->alive.append(trial.get());
+            allTrials.push_back(std::move(trial));
+        }
+        brackets.push_back(std::move(bracket));
+    }
+
+    WorkStealingPool pool(parser.isSet("search-threads") ? parser.value("search-threads").toInt() : 0);
+    Search search;
+    search.trainingData = &trainingData;
+    search.pool = &pool;
+    search.budget = base.maxSteps;
+    search.eta = eta;
+    search.out = &out;
+
+    out << QString("%1 search, %2: %3 runs in %4 brackets, budget %5 steps, %6 threads").arg(strategy).arg(schedule)
+           .arg(allTrials.size()).arg(brackets.size()).arg(base.maxSteps).arg(pool.threadCount()) << Qt::endl;
+
+    QElapsedTimer timer;
+    timer.start();
+    //all brackets at once, a bracket submits its next rung when its current one is done
+    for (auto& bracket : brackets) submitRung(search, *bracket);
+    pool.wait();
+    const qint64 wallMs = timer.elapsed();
+
+    QVector<Trial*> ranking;
+    qint64 trainingMs = 0, steps = 0;
+    for (auto& trial : allTrials) {
+        trial->testError = trial->network.computeError(testData);
+        trainingMs += trial->timeMs;
+        steps += trial->trainer->stepCounter;
+        ranking.append(trial.get());
+    }
+    std::stable_sort(ranking.begin(), ranking.end(), isBetter);
+
+    QStringList header = { "rank", "neurons", "learning_rate", "init_sigma", "optimizer", "steps",
+                           "train_error", "test_error", "time_ms", "status" };
+    auto row = [](int rank, const Trial& trial) {
+        const TrainingOptions& options = trial.options;
+        QString status = trial.killed ? QString("stopped@%1").arg(trial.rung) : reached(trial) ? "reached" : "done";
+        return QStringList{ QString::number(rank), QString::number(options.numNeurons), QString::number(options.learningRate),
+                            QString("%1:%2").arg(options.initStdDevMin).arg(options.initStdDevMax),
+                            RRBFOptimizer::typeName(options.optimizer), QString::number(trial.trainer->stepCounter),
+                            QString::number(trial.trainer->totalError, 'f', 6), QString::number(trial.testError, 'f', 6),
+                            QString::number(trial.timeMs), status };
+    };
+
+    out << Qt::endl << QString("%1 ms wall, %2 ms of training (%3x parallel), %4 steps, %5 jobs stolen")
+           .arg(wallMs).arg(trainingMs).arg(double(trainingMs) / qMax<qint64>(1, wallMs), 0, 'f', 2)
+           .arg(steps).arg(pool.stealCount()) << Qt::endl;
+    for (const QString& column : header) out << column.leftJustified(14);
+    out << Qt::endl;
+    for (int r = 0; r < ranking.size() && (leaderboard <= 0 || r < leaderboard); ++r) {
+        for (const QString& value : row(r + 1, *ranking[r])) out << value.leftJustified(14);
+        out << Qt::endl;
+    }
+
+    const TrainingOptions& best = ranking.first()->options;
+    out << Qt::endl << QString("best: --neurons %1 --learning-rate %2 --init-sigma %3:%4 --optimizer %5 --seed %6")
+           .arg(best.numNeurons).arg(best.learningRate).arg(best.initStdDevMin).arg(best.initStdDevMax)
+           .arg(RRBFOptimizer::typeName(best.optimizer)).arg(best.seed) << Qt::endl;
+
+    if (parser.isSet("save-model") && !ranking.first()->network.save(parser.value("save-model"))) return 1;
+
+    if (parser.isSet("csv")) {
+        QFile file(parser.value("csv"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            out << "error: cannot write " << parser.value("csv") << Qt::endl;
+            return 1;
+        }
+        QTextStream csv(&file);
+        csv << header.join(',') << '\n';
+        for (int r = 0; r < ranking.size(); ++r) csv << row(r + 1, *ranking[r]).join(',') << '\n';
+    }
+    return 0;
+}
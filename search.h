@@ -0,0 +1,15 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <QCommandLineParser>
+
+// headless hyperparameter search over --neurons, --learning-rate,
+// --init-sigma and --optimizer. Candidates come from the grid of the comma
+// separated values or are drawn at random (a "min:max" value is a range);
+// the training runs are scheduled on a WorkStealingPool, poor runs are
+// stopped early by successive halving or Hyperband on the training error,
+// and the result is a leaderboard plus the command line of the best run
+void addSearchOptions(QCommandLineParser& parser);
+int runSearch(const QCommandLineParser& parser);
+
+#endif // SEARCH_H
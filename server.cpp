@@ -0,0 +1,265 @@
+#include "server.h"
+#include "rrbfnetwork.h"
+
+#include <QCoreApplication>
+#include <QFileSystemWatcher>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+qint64 quantile(std::vector<qint64>& values, double q)
+{
+    if (values.empty()) return 0;
+    auto nth = values.begin() + static_cast<std::ptrdiff_t>(q * (values.size() - 1));
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+}
+
+InferenceServer::InferenceServer(std::unique_ptr<const RRBFPredictor> model)
+    : store(std::move(model))
+{
+    watcher = nullptr;
+    cullTolerance = 0.0;
+    localServer = nullptr;
+    tcpServer = nullptr;
+    reportIntervalMs = 5000;
+    flushScheduled = false;
+    requests = samples = batches = 0;
+    clock.start();
+    windowStartNs = 0;
+
+    reportTimer = new QTimer();
+    QObject::connect(reportTimer, &QTimer::timeout, [this]() {
+        if (requests == 0) return;
+        QTextStream out(stdout);
+        out << report() << Qt::endl;
+    });
+}
+
+InferenceServer::~InferenceServer()
+{
+    reloading.waitForFinished();
+    delete watcher;
+    delete reportTimer;
+    delete localServer;
+    delete tcpServer;
+}
+
+bool InferenceServer::listenLocal(const QString& name)
+{
+    localServer = new QLocalServer();
+    QLocalServer::removeServer(name); //stale socket of a crashed server
+    if (!localServer->listen(name)) {
+        error = localServer->errorString();
+        return false;
+    }
+    QObject::connect(localServer, &QLocalServer::newConnection, [this]() {
+        while (QLocalSocket* socket = localServer->nextPendingConnection()) {
+            QObject::connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+            accept(socket);
+        }
+    });
+    reportTimer->start(reportIntervalMs);
+    return true;
+}
+
+bool InferenceServer::listenTcp(quint16 port)
+{
+    tcpServer = new QTcpServer();
+    if (!tcpServer->listen(QHostAddress::LocalHost, port)) {
+        error = tcpServer->errorString();
+        return false;
+    }
+    QObject::connect(tcpServer, &QTcpServer::newConnection, [this]() {
+        while (QTcpSocket* socket = tcpServer->nextPendingConnection()) {
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            accept(socket);
+        }
+    });
+    reportTimer->start(reportIntervalMs);
+    return true;
+}
+
+QString InferenceServer::errorString() const
+{
+    return error;
+}
+
+void InferenceServer::watch(const QString& fileName)
+{
+    watcher = new QFileSystemWatcher();
+    watcher->addPath(fileName);
+    QObject::connect(watcher, &QFileSystemWatcher::fileChanged, [this](const QString& path) {
+        //editors and "mv new.json model.json" replace the file, watch the new one
+        if (!watcher->files().contains(path)) watcher->addPath(path);
+        //changes during a reload are picked up by the next one
+        if (reloading.isRunning()) return;
+        reloading = QtConcurrent::run([this, path]() { reload(path); });
+    });
+}
+
+void InferenceServer::reload(const QString& fileName)
+{
+    //runs on a worker thread, inference continues on the old model meanwhile
+    QTextStream out(stdout);
+    RRBFNetwork network;
+    if (!network.load(fileName) || network.numNeurons == 0) {
+        out << "Reload of " << fileName << " failed, keeping the current model" << Qt::endl;
+        return;
+    }
+    std::unique_ptr<RRBFPredictor> model(new RRBFPredictor(network));
+    model->enableCulling(cullTolerance);
+    store.publish(std::move(model));
+    out << "Reloaded " << fileName << ": " << network.numNeurons << " neurons, model version " << store.version() << Qt::endl;
+}
+
+void InferenceServer::accept(QIODevice* socket)
+{
+    QObject::connect(socket, &QIODevice::readyRead, [this, socket]() { readRequests(socket); });
+    //answers for a connection that is gone are dropped in flush()
+    QObject::connect(socket, &QObject::destroyed, [this, socket]() { dropPending(socket); });
+}
+
+void InferenceServer::dropPending(QIODevice* socket)
+{
+    for (Pending& request : pending) {
+        if (request.socket == socket) request.socket = nullptr;
+    }
+}
+
+void InferenceServer::readRequests(QIODevice* socket)
+{
+    //take every complete request, partial ones wait for the next readyRead
+    while (socket->bytesAvailable() >= qint64(sizeof(quint32))) {
+        quint32 count;
+        socket->peek(reinterpret_cast<char*>(&count), sizeof(count));
+        if (count > maxRequestSize) {
+            //requests of this socket read before stay in the batch, unanswered
+            dropPending(socket);
+            socket->close();
+            return;
+        }
+        const qint64 payload = qint64(count) * 2 * sizeof(double);
+        if (socket->bytesAvailable() < qint64(sizeof(count)) + payload) break;
+
+        socket->read(reinterpret_cast<char*>(&count), sizeof(count));
+        Pending request;
+        request.socket = socket;
+        request.offset = inputs.size() / 2;
+        request.count = count;
+        request.arrivalNs = clock.nsecsElapsed();
+        inputs.resize(inputs.size() + 2 * count);
+        socket->read(reinterpret_cast<char*>(inputs.data() + 2 * request.offset), payload);
+        pending.push_back(request);
+    }
+    if (!pending.empty()) scheduleFlush();
+}
+
+void InferenceServer::scheduleFlush()
+{
+    //run after all sockets with data in this event loop iteration were read
+    if (flushScheduled) return;
+    flushScheduled = true;
+    QTimer::singleShot(0, [this]() { flush(); });
+}
+
+void InferenceServer::flush()
+{
+    flushScheduled = false;
+    if (pending.empty()) return;
+
+    const std::size_t total = inputs.size() / 2;
+    if (outputs.size() < total) outputs.resize(total);
+    {
+        ModelStore::ReadGuard model(store);
+        model->predict(inputs.data(), outputs.data(), total);
+    }
+
+    for (const Pending& request : pending) {
+        if (request.socket) {
+            request.socket->write(reinterpret_cast<const char*>(outputs.data() + request.offset),
+                                  qint64(request.count * sizeof(double)));
+        }
+        latencies.push_back(clock.nsecsElapsed() - request.arrivalNs);
+        samples += request.count;
+    }
+    requests += pending.size();
+    batches++;
+
+    //clear() keeps the capacity, the next batch does not allocate
+    inputs.clear();
+    pending.clear();
+}
+
+QString InferenceServer::report()
+{
+    const qint64 nowNs = clock.nsecsElapsed();
+    const double seconds = qMax(1e-9, (nowNs - windowStartNs) * 1e-9);
+
+    QString text = QString("requests/s %1, samples/s %2, requests per batch %3, latency p50 %4 us, p99 %5 us, max %6 us")
+            .arg(requests / seconds, 0, 'f', 0).arg(samples / seconds, 0, 'f', 0)
+            .arg(batches > 0 ? double(requests) / batches : 0.0, 0, 'f', 1)
+            .arg(quantile(latencies, 0.5) / 1000.0, 0, 'f', 1).arg(quantile(latencies, 0.99) / 1000.0, 0, 'f', 1)
+            .arg(latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end()) / 1000.0, 0, 'f', 1);
+
+    windowStartNs = nowNs;
+    requests = samples = batches = 0;
+    latencies.clear();
+    return text;
+}
+
+void addServerOptions(QCommandLineParser& parser)
+{
+    parser.addOptions({
+        {"serve", "Serve predictions of this model file (see server.h for the protocol).", "file"},
+        {"socket", "Unix socket name of the server (default rrbf-inference).", "name"},
+        {"port", "Listen on this localhost TCP port instead of a Unix socket.", "port"},
+        {"report-every", "Seconds between two throughput/latency reports (default 5).", "seconds"},
+        {"watch", "Reload the served model whenever its file changes."},
+        {"cull-tolerance", "Skip neuron terms below this value when predicting (default 0 = exact).", "value"},
+    });
+}
+
+int runServer(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+
+    RRBFNetwork network;
+    if (!network.load(parser.value("serve"))) return 1;
+
+    double cullTolerance = parser.isSet("cull-tolerance") ? parser.value("cull-tolerance").toDouble() : 0.0;
+    std::unique_ptr<RRBFPredictor> model(new RRBFPredictor(network));
+    model->enableCulling(cullTolerance);
+
+    InferenceServer server(std::move(model));
+    server.cullTolerance = cullTolerance;
+    if (parser.isSet("watch")) server.watch(parser.value("serve"));
+    if (parser.isSet("report-every")) server.reportIntervalMs = qMax(1, int(parser.value("report-every").toDouble() * 1000));
+
+    if (parser.isSet("port")) {
+        if (!server.listenTcp(static_cast<quint16>(parser.value("port").toUInt()))) {
+            out << "error: cannot listen on port " << parser.value("port") << ": " << server.errorString() << Qt::endl;
+            return 1;
+        }
+        out << "Serving " << network.numNeurons << " neurons on 127.0.0.1:" << parser.value("port") << Qt::endl;
+    } else {
+        QString name = parser.isSet("socket") ? parser.value("socket") : QString("rrbf-inference");
+        if (!server.listenLocal(name)) {
+            out << "error: cannot listen on " << name << ": " << server.errorString() << Qt::endl;
+            return 1;
+        }
+        out << "Serving " << network.numNeurons << " neurons on " << name << Qt::endl;
+    }
+    return QCoreApplication::exec();
+}
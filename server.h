@@ -0,0 +1,92 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "modelstore.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QString>
+#include <vector>
+
+class QFileSystemWatcher;
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+class QTimer;
+
+// Serves predictions of a loaded model over a Unix socket or localhost TCP.
+//
+// Protocol, native byte order, any number of requests per connection:
+//   request   quint32 count, then count x (double x, double y)
+//   response  count x double
+//
+// Requests that arrive in the same event loop iteration, from any
+// connection, are evaluated as one batch. Inputs are read straight into
+// buffers that only ever grow. Every reportIntervalMs the throughput and
+// the p50/p99/max latency (request complete -> response written) are
+// printed.
+//
+// watch() reloads the model file whenever it changes. Loading runs on a
+// worker thread and the result is swapped in through the ModelStore, so
+// serving never stops: batches already running finish on the old model.
+class InferenceServer
+{
+public:
+    explicit InferenceServer(std::unique_ptr<const RRBFPredictor> model);
+    ~InferenceServer();
+
+    void watch(const QString& fileName);
+    double cullTolerance;   // applied to reloaded models, see RRBFPredictor::enableCulling()
+
+    bool listenLocal(const QString& name);
+    bool listenTcp(quint16 port);
+    QString errorString() const;
+
+    int reportIntervalMs;
+    static const quint32 maxRequestSize = 1 << 20; // samples, larger requests close the connection
+
+    QString report(); // statistics since the last report
+
+private:
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    struct Pending
+    {
+        QIODevice* socket;
+        std::size_t offset; // in samples
+        std::size_t count;
+        qint64 arrivalNs;
+    };
+
+    void accept(QIODevice* socket);
+    void readRequests(QIODevice* socket);
+    void dropPending(QIODevice* socket); // flush() skips the answers to it
+    void scheduleFlush();
+    void flush();
+    void reload(const QString& fileName);
+
+    ModelStore store;
+    QFileSystemWatcher* watcher;
+    QFuture<void> reloading;
+    QLocalServer* localServer;
+    QTcpServer* tcpServer;
+    QTimer* reportTimer;
+    QString error;
+
+    std::vector<double> inputs;     // interleaved x, y of all pending requests
+    std::vector<double> outputs;
+    std::vector<Pending> pending;
+    bool flushScheduled;
+
+    QElapsedTimer clock;
+    qint64 windowStartNs;
+    qint64 requests, samples, batches;
+    std::vector<qint64> latencies;  // ns, this report window
+};
+
+void addServerOptions(QCommandLineParser& parser);
+int runServer(const QCommandLineParser& parser);
+
+#endif // SERVER_H
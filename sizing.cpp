@@ -0,0 +1,151 @@
+#include "sizing.h"
+#include "commandline.h"
+#include "rrbftrainer.h"
+#include "threadpool.h"
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct SizingTrial
+{
+    int neurons;
+    quint32 seed;
+    bool passed;
+    double testError;       // at the last check
+    qint64 steps;
+    qint64 timeMs;
+    RRBFNetwork network;
+};
+
+// trains until the test error is below target (checked every testInterval
+// steps) or the trainer finishes on its own
+void train(SizingTrial& trial, TrainingOptions options, const TrainingSet& trainingData,
+           const TrainingSet& testData, double target, qint64 testInterval)
+{
+    QElapsedTimer timer;
+    timer.start();
+    options.numNeurons = trial.neurons;
+    options.seed = trial.seed;
+    RRBFTrainer trainer(trial.network, trainingData);
+    trainer.start(options);
+
+    trial.testError = trial.network.computeError(testData);
+    while (trial.testError >= target && !trainer.isFinished()) {
+        trainer.trainStep();
+        if (trainer.stepCounter % testInterval == 0 || trainer.isFinished()) {
+            trial.testError = trial.network.computeError(testData);
+        }
+    }
+    trial.passed = trial.testError < target;
+    trial.steps = trainer.stepCounter;
+    trial.timeMs = timer.elapsed();
+}
+
+}
+
+void addSizingOptions(QCommandLineParser& parser)
+{
+    parser.addOptions({
+        {"min-neurons", "Search the smallest --neurons min:max count whose test error is below this target.", "error"},
+        {"test-every", "Steps between two test error checks of the neuron count search (default 10 epochs).", "steps"},
+    });
+}
+
+int runSizing(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+
+    const double target = parser.value("min-neurons").toDouble();
+    QStringList range = (parser.isSet("neurons") ? parser.value("neurons") : QString("1:64")).split(':');
+    int failing = qMax(1, range.value(0).toInt()) - 1;  // largest count known to miss the target
+    const int maxNeurons = range.value(1, range.value(0)).toInt();
+    if (target <= 0.0 || maxNeurons <= failing) {
+        out << "error: --min-neurons needs a target error > 0 and --neurons min:max" << Qt::endl;
+        return 1;
+    }
+
+    //stop condition, init, optimizer, ... as given, every run ends at maxSteps
+    TrainingOptions base = trainingOptionsFromParser(parser, TrainingOptions());
+    if (!parser.isSet("max-steps")) base.maxSteps = 50000;
+    QStringList seeds = (parser.isSet("seed") ? parser.value("seed") : QString("1")).split(',', Qt::SkipEmptyParts);
+
+    const TrainingSet trainingData = RRBFNetwork::createTrainingDataSet();
+    const double testStep = parser.isSet("test-step") ? parser.value("test-step").toDouble() : 0.1;
+    const TrainingSet testData = RRBFNetwork::createTestDataSet(testStep);
+    const qint64 testInterval = qMax<qint64>(1, parser.isSet("test-every") ? parser.value("test-every").toLongLong()
+                                                                           : 10 * trainingData.size());
+
+    WorkStealingPool pool(parser.isSet("search-threads") ? parser.value("search-threads").toInt() : 0);
+    const int candidatesPerRound = pool.threadCount();
+    out << QString("smallest network with test error < %1 in %2..%3 neurons, %4 candidates per round")
+           .arg(target).arg(failing + 1).arg(maxNeurons).arg(candidatesPerRound) << Qt::endl;
+
+    int passing = -1;   // smallest count known to reach the target
+    std::unique_ptr<SizingTrial> best;
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 1; passing < 0 || passing - failing > 1; ++round) {
+        //evenly spaced counts in (failing, upper], the upper end itself until one passed
+        const int upper = passing < 0 ? maxNeurons : passing - 1;
+        QVector<int> counts;
+        for (int j = 1; j <= candidatesPerRound; ++j) {
+            int count = failing + static_cast<int>((qint64(upper - failing) * j + candidatesPerRound - 1) / candidatesPerRound);
+            if (counts.isEmpty() || counts.last() != count) counts.append(count);
+        }
+
+        std::vector<std::unique_ptr<SizingTrial>> trials;
+        for (int count : counts) {
+            for (const QString& seed : seeds) {
+                std::unique_ptr<SizingTrial> trial(new SizingTrial);
+                trial->neurons = count;
+                trial->seed = seed.toUInt();
+                trial->passed = false;
+                trials.push_back(std::move(trial));
+            }
+        }
+        for (auto& trial : trials) {
+            SizingTrial* t = trial.get();
+            pool.submit([t, &base, &trainingData, &testData, target, testInterval]() {
+                train(*t, base, trainingData, testData, target, testInterval);
+            });
+        }
+        pool.wait();
+
+        //smallest passing count; non-monotonic results are resolved in favour of it
+        for (auto& trial : trials) {
+            out << QString("round %1: %2 neurons, seed %3: test error %4 after %5 steps (%6 ms), %7").arg(round)
+                   .arg(trial->neurons).arg(trial->seed).arg(trial->testError, 0, 'f', 6).arg(trial->steps)
+                   .arg(trial->timeMs).arg(trial->passed ? "pass" : "fail") << Qt::endl;
+            if (trial->passed && (passing < 0 || trial->neurons < passing || (trial->neurons == passing
+                                                                               && trial->testError < best->testError))) {
+                passing = trial->neurons;
+                best = std::move(trial);
+            }
+        }
+        for (auto& trial : trials) {
+            if (trial && !trial->passed && trial->neurons > failing && (passing < 0 || trial->neurons < passing)) {
+                //a count passes if any seed does
+                bool anySeed = false;
+                for (auto& other : trials) anySeed |= other && other->neurons == trial->neurons && other->passed;
+                if (!anySeed) failing = trial->neurons;
+            }
+        }
+        if (passing < 0 && counts.last() == maxNeurons) {
+            out << QString("no count up to %1 neurons reaches test error %2 within %3 steps (%4 ms)").arg(maxNeurons)
+                   .arg(target).arg(base.maxSteps).arg(timer.elapsed()) << Qt::endl;
+            return 1;
+        }
+    }
+
+    out << QString("smallest network: %1 neurons (seed %2), test error %3, %4 ns per prediction, search took %5 ms")
+           .arg(best->neurons).arg(best->seed).arg(best->testError, 0, 'f', 6)
+           .arg(nsPerPrediction(best->network, testData), 0, 'f', 1).arg(timer.elapsed()) << Qt::endl;
+
+    if (parser.isSet("save-model") && !best->network.save(parser.value("save-model"))) return 1;
+    return 0;
+}
@@ -0,0 +1,16 @@
+#ifndef SIZING_H
+#define SIZING_H
+
+#include <QCommandLineParser>
+
+// headless search for the smallest neuron count in the --neurons min:max
+// range whose test error on the drawTestGraph() grid drops below the
+// --min-neurons target. Every round trains one candidate count per worker
+// thread in parallel and narrows the range to the smallest passing and the
+// largest failing count (k-section, bisection with one thread). Assumes
+// that more neurons never hurt; a count passes if any --seed reaches the
+// target within --max-steps.
+void addSizingOptions(QCommandLineParser& parser);
+int runSizing(const QCommandLineParser& parser);
+
+#endif // SIZING_H
@@ -0,0 +1,70 @@
+#include "rrbftrainer.h"
+#include "profiler.h"
+
+// Sparse SGD step. Each sample only yields gradients for the neurons whose
+// phi_x or phi_y is above options.sparseThreshold. They are summed into the
+// batch_* vectors, which stay zero everywhere else, and only the touched
+// neurons are averaged and updated. The entries are zeroed again at the
+// start of the next step, so gradientNorms() still sees the last gradient.
+
+void RRBFTrainer::sparseGradientStep(double learningRate)
+{
+    const int numNeurons = network.numNeurons;
+    if (batch_weights.size() != numNeurons) {
+        batch_weights.fill(0.0, numNeurons);
+        batch_stdDevs.fill(0.0, numNeurons);
+        batch_centers.fill(0.0, numNeurons);
+        isTouched.fill(false, numNeurons);
+        touched.clear();
+    }
+    for (int i : touched) {
+        batch_weights[i] = 0.0;
+        batch_stdDevs[i] = 0.0;
+        batch_centers[i] = 0.0;
+        isTouched[i] = false;
+    }
+    touched.clear();
+
+    const int batchSize = qMax(1, options.batchSize);
+    for (int b = 0; b < batchSize; ++b) {
+        const auto& data = trainingData[dataIndex];
+
+        {
+            RRBF_PROFILE_SCOPE(PhaseGradient);
+            if (options.perfCounters) gradientPerf.start();
+            network.computeSparseGradients(data.first.first, data.first.second, data.second, options.sparseThreshold,
+                                           active, grad_weights, grad_stdDevs, grad_centers);
+            if (options.perfCounters) gradientPerf.stop();
+        }
+        for (int j = 0; j < active.size(); ++j) {
+            int i = active[j];
+            if (!isTouched[i]) {
+                isTouched[i] = true;
+                touched.append(i);
+            }
+            batch_weights[i] += grad_weights[j];
+            batch_stdDevs[i] += grad_stdDevs[j];
+            batch_centers[i] += grad_centers[j];
+        }
+        activeSum += active.size();
+        activeSamples++;
+
+        dataIndex = (dataIndex + 1) % trainingData.size();
+        if (dataIndex == 0) {
+            epochCounter++;
+            activeFraction = double(activeSum) / (double(activeSamples) * qMax(1, numNeurons));
+            activeSum = 0;
+            activeSamples = 0;
+        }
+    }
+
+    RRBF_PROFILE_SCOPE(PhaseUpdate);
+    if (batchSize > 1) {
+        for (int i : touched) {
+            batch_weights[i] /= batchSize;
+            batch_stdDevs[i] /= batchSize;
+            batch_centers[i] /= batchSize;
+        }
+    }
+    optimizer.sparseStep(network, touched, batch_weights, batch_stdDevs, batch_centers, learningRate);
+}
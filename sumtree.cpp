@@ -0,0 +1,57 @@
+#include "sumtree.h"
+
+SumTree::SumTree()
+{
+    count = 0;
+    capacity = 1;
+    sums.fill(0.0, 2);
+}
+
+void SumTree::reset(int size_, double priority)
+{
+    count = qMax(0, size_);
+    capacity = 1;
+    while (capacity < count) capacity *= 2;
+
+    //unused leaves count as zero
+    sums.fill(0.0, 2 * capacity);
+    for (int i = 0; i < count; ++i) sums[capacity + i] = priority;
+    for (int node = capacity - 1; node > 0; --node) sums[node] = sums[2 * node] + sums[2 * node + 1];
+}
+
+void SumTree::set(int i, double priority)
+{
+    int node = capacity + i;
+    sums[node] = priority;
+    for (node /= 2; node > 0; node /= 2) sums[node] = sums[2 * node] + sums[2 * node + 1];
+}
+
+double SumTree::priority(int i) const
+{
+    return sums[capacity + i];
+}
+
+double SumTree::total() const
+{
+    return sums[1];
+}
+
+int SumTree::size() const
+{
+    return count;
+}
+
+int SumTree::find(double u) const
+{
+    int node = 1;
+    while (node < capacity) {
+        if (u < sums[2 * node] || sums[2 * node + 1] <= 0.0) {
+            node = 2 * node;
+        } else {
+            u -= sums[2 * node];
+            node = 2 * node + 1;
+        }
+    }
+    //rounding can step past the last used leaf
+    return qMin(node - capacity, count - 1);
+}
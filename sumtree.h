@@ -0,0 +1,28 @@
+#ifndef SUMTREE_H
+#define SUMTREE_H
+
+#include <QVector>
+
+// binary tree over non-negative priorities, stored as one array: every
+// inner node holds the sum of its children.
+// set() and find() are O(log n), so a prioritized sampler stays cheap when
+// priorities change after every training step.
+class SumTree
+{
+public:
+    SumTree();
+
+    void reset(int size_, double priority = 0.0);
+    void set(int i, double priority);
+    double priority(int i) const;
+    double total() const;
+    int size() const;
+    // the index whose priority interval contains u, for u in [0, total())
+    int find(double u) const;
+
+private:
+    int count, capacity;        // used leaves, leaves (a power of two)
+    QVector<double> sums;       // node 1 is the root, leaf i is node capacity + i
+};
+
+#endif // SUMTREE_H
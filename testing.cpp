@@ -3,7 +3,7 @@
 
 void MainWindow::FindZ()
 {
-    if (numNeurons == 0 || centers.isEmpty() || stdDevs.isEmpty() || weights.isEmpty()) {
+    if (network.numNeurons == 0 || network.centers.isEmpty() || network.stdDevs.isEmpty() || network.weights.isEmpty()) {
         ui->zFoundLabel->setText("Z is found: N/A (Train the network first)");
         ui->zMustBeLabel->setText("Z must be: N/A (Train the network first)");
         return;
@@ -12,7 +12,7 @@ void MainWindow::FindZ()
     double x = ui->doubleSpinBox_test_x->value();
     double y = ui->doubleSpinBox_test_y->value();
 
-    double z_found = computeOutput(x, y);
+    double z_found = network.computeOutput(x, y);
 
     double x_val = (x == 0.0) ? 0.0001 : x;
     double y_val = (y == 0.0) ? 0.0001 : y;
@@ -23,7 +23,7 @@ void MainWindow::FindZ()
 }
 void MainWindow::drawTestGraph()
 {
-    if (numNeurons == 0 || centers.isEmpty() || stdDevs.isEmpty() || weights.isEmpty()) {
+    if (network.numNeurons == 0 || network.centers.isEmpty() || network.stdDevs.isEmpty() || network.weights.isEmpty()) {
         qDebug() << "Error: Network not trained yet!";
         return;
     }
@@ -35,7 +35,7 @@ void MainWindow::drawTestGraph()
     int index = 0;
     for (double x = -3.0; x <= 3.0; x += ui->doubleSpinBox_test_step_size->value()) { // Daha yoğun veri için 0.1 adımla
         for (double y = -3.0; y <= 3.0; y +=  ui->doubleSpinBox_test_step_size->value()) {
-            double z_found = computeOutput(x, y);
+            double z_found = network.computeOutput(x, y);
 
             double x_val = (x == 0.0) ? 0.0001 : x;
             double y_val = (y == 0.0) ? 0.0001 : y;
@@ -0,0 +1,118 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+namespace {
+
+// the pool and index of the worker running on this thread, if any
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local int currentWorker = -1;
+
+}
+
+WorkStealingPool::WorkStealingPool(int threads)
+{
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    pending = 0;
+    steals = 0;
+    next = 0;
+    stopping = false;
+    queued = 0;
+    for (int t = 0; t < threads; ++t) queues.emplace_back(new Queue);
+    for (int t = 0; t < threads; ++t) this->threads.emplace_back(&WorkStealingPool::run, this, t);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work.notify_all();
+    for (std::thread& thread : threads) thread.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> job)
+{
+    int target;
+    {
+        //counted before the job is visible, so that it cannot finish uncounted
+        std::lock_guard<std::mutex> lock(mutex);
+        pending++;
+        queued++;
+        target = currentPool == this ? currentWorker : static_cast<int>(next++ % queues.size());
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->jobs.push_back(std::move(job));
+    }
+    work.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return pending == 0; });
+}
+
+int WorkStealingPool::threadCount() const
+{
+    return static_cast<int>(threads.size());
+}
+
+long long WorkStealingPool::stealCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return steals;
+}
+
+bool WorkStealingPool::take(int worker, std::function<void()>& job)
+{
+    const int count = static_cast<int>(queues.size());
+    for (int k = 0; k < count; ++k) {
+        //own deque from the back, the others from the front
+        const int victim = (worker + k) % count;
+        Queue& queue = *queues[victim];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty()) continue;
+            if (k == 0) {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            } else {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        queued--;
+        if (k != 0) steals++;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int worker)
+{
+    currentPool = this;
+    currentWorker = worker;
+
+    std::function<void()> job;
+    while (true) {
+        if (take(worker, job)) {
+            job();
+            job = nullptr;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                done.notify_all();
+                if (stopping) work.notify_all(); //the idle workers may exit now
+            }
+            continue;
+        }
+
+        //a job counted in queued may not be pushed yet, then take() simply runs again
+        std::unique_lock<std::mutex> lock(mutex);
+        work.wait(lock, [this]() { return queued > 0 || (stopping && pending == 0); });
+        if (queued == 0 && stopping && pending == 0) return;
+    }
+}
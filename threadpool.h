@@ -0,0 +1,56 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one job deque each. A worker runs the
+// newest job of its own deque first (LIFO, the data it just touched is still
+// in cache) and, when that is empty, steals the oldest job of another
+// worker. Jobs submitted from inside a job go to the submitting worker's
+// deque, jobs from other threads are dealt out round robin.
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int threads); // <= 0: one per core
+    ~WorkStealingPool();                    // finishes all submitted jobs first
+
+    void submit(std::function<void()> job);
+    // blocks until every job submitted so far, and every job those
+    // submitted, has finished; must not be called from a job
+    void wait();
+    int threadCount() const;
+    long long stealCount() const;           // jobs run by another worker than the one they were queued on
+
+private:
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    bool take(int worker, std::function<void()>& job);
+    void run(int worker);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    mutable std::mutex mutex;
+    std::condition_variable work;   // workers: a job was submitted or stopping
+    std::condition_variable done;   // wait(): pending dropped to zero
+    long long pending;              // submitted and not yet finished
+    long long queued;               // submitted and not yet taken
+    long long steals;
+    unsigned next;                  // round robin target of outside submits
+    bool stopping;
+};
+
+#endif // THREADPOOL_H